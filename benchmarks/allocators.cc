@@ -0,0 +1,166 @@
+// Benchmarks for the allocator overloads. Each case calls the overload with
+// a fresh _::Arena, as per-request code would, and the baseline is the same
+// function without an allocator, so the difference is what the arena saves
+// over the global heap. The cases cover the three ways the overloads use
+// their allocator: for the result (map, filter, scan, partition), for
+// scratch space as well (sort_by, uniq), and for a hash table (semi_join).
+// The other overloads build their results and scratch space the same way.
+
+#include <algorithm>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+#include "harness.h"
+#include "underscore/arena.h"
+
+namespace benchmarks {
+namespace {
+
+typedef _::Arena<16384> Arena;
+
+template<typename Container>
+struct MapArena : Case<Container> {
+  using Case<Container>::Case;
+
+  void underscore() {
+    Arena arena;
+    keep(_::map<std::pmr::vector<long long> >(
+        this->input,
+        Key(),
+        arena.allocator()));
+  }
+
+  void baseline() {
+    keep(_::map<std::vector<long long> >(this->input, Key()));
+  }
+};
+UNDERSCORE_BENCHMARK(MapArena, "map(arena)");
+
+template<typename Container>
+struct FilterArena : Case<Container> {
+  typedef typename Container::value_type T;
+  using Case<Container>::Case;
+
+  void underscore() {
+    Arena arena;
+    keep(_::filter<std::pmr::vector<T> >(
+        this->input,
+        IsEven(),
+        arena.allocator()));
+  }
+
+  void baseline() {
+    keep(_::filter<std::vector<T> >(this->input, IsEven()));
+  }
+};
+UNDERSCORE_BENCHMARK(FilterArena, "filter(arena)");
+
+template<typename Container>
+struct ScanArena : Case<Container> {
+  using Case<Container>::Case;
+
+  void underscore() {
+    Arena arena;
+    keep(_::scan<std::pmr::vector<long long> >(
+        this->input,
+        Plus(),
+        0LL,
+        Key(),
+        arena.allocator()));
+  }
+
+  void baseline() {
+    keep(_::scan<std::vector<long long> >(this->input, Plus(), 0LL, Key()));
+  }
+};
+UNDERSCORE_BENCHMARK(ScanArena, "scan(arena)");
+
+template<typename Container>
+struct PartitionArena : Case<Container> {
+  typedef typename Container::value_type T;
+  using Case<Container>::Case;
+
+  void underscore() {
+    Arena arena;
+    keep(_::partition<std::pmr::vector<T> >(
+        this->input,
+        IsEven(),
+        arena.allocator()));
+  }
+
+  void baseline() {
+    keep(_::partition<std::vector<T> >(this->input, IsEven()));
+  }
+};
+UNDERSCORE_BENCHMARK(PartitionArena, "partition(arena)");
+
+// sort_by without an allocator returns the input's own container type, so
+// the baseline sorts a std::vector by hand instead.
+template<typename Container>
+struct SortByArena : Case<Container> {
+  typedef typename Container::value_type T;
+  using Case<Container>::Case;
+
+  void underscore() {
+    Arena arena;
+    keep(_::sort_by<std::pmr::vector<T> >(
+        this->input,
+        Less(),
+        arena.allocator()));
+  }
+
+  void baseline() {
+    std::vector<T> sorted(this->input.begin(), this->input.end());
+    std::sort(sorted.begin(), sorted.end(), Less());
+    keep(sorted);
+  }
+};
+UNDERSCORE_BENCHMARK(SortByArena, "sort_by(arena)");
+
+template<typename Container>
+struct UniqArena : Case<Container> {
+  typedef typename Container::value_type T;
+  using Case<Container>::Case;
+
+  void underscore() {
+    Arena arena;
+    keep(_::uniq<std::pmr::vector<T>, long long>(
+        this->input,
+        Key(),
+        arena.allocator()));
+  }
+
+  void baseline() {
+    keep(_::uniq<std::vector<T>, long long>(this->input, Key()));
+  }
+};
+UNDERSCORE_BENCHMARK(UniqArena, "uniq(arena)");
+
+template<typename Container>
+struct SemiJoinArena : Paired<Container> {
+  typedef typename Container::value_type T;
+  using Paired<Container>::Paired;
+
+  void underscore() {
+    Arena arena;
+    keep(_::semi_join<std::pmr::vector<T>, long long>(
+        this->input,
+        this->other,
+        Key(),
+        Key(),
+        arena.allocator()));
+  }
+
+  void baseline() {
+    keep(_::semi_join<std::vector<T>, long long>(
+        this->input,
+        this->other,
+        Key(),
+        Key()));
+  }
+};
+UNDERSCORE_BENCHMARK(SemiJoinArena, "semi_join(arena)");
+
+}  // namespace
+}  // namespace benchmarks
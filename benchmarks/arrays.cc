@@ -0,0 +1,779 @@
+// Benchmarks for the Arrays functions.
+
+#include <algorithm>
+#include <iterator>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "harness.h"
+
+namespace benchmarks {
+namespace {
+
+template<typename Container>
+struct Rest : Case<Container> {
+  typedef typename Container::value_type T;
+  explicit Rest(Container const& input) : Case<Container>(input), data(input) {
+  }
+
+  void underscore() {
+    keep(_::rest<std::vector<T> >(data));
+  }
+
+  void baseline() {
+    keep(std::vector<T>(std::next(data.begin()), data.end()));
+  }
+
+  Container data;
+};
+UNDERSCORE_BENCHMARK(Rest, "rest");
+
+template<typename Container>
+struct Initial : Case<Container> {
+  typedef typename Container::value_type T;
+  explicit Initial(Container const& input)
+      : Case<Container>(input), data(input) {
+  }
+
+  void underscore() {
+    keep(_::initial<std::vector<T> >(data));
+  }
+
+  void baseline() {
+    keep(std::vector<T>(
+        data.begin(),
+        std::next(data.begin(), data.size() - 1)));
+  }
+
+  Container data;
+};
+UNDERSCORE_BENCHMARK(Initial, "initial");
+
+template<typename Container>
+struct Chunk : Case<Container> {
+  using Case<Container>::Case;
+
+  static std::size_t const kSize = 64;
+
+  void underscore() {
+    long long sum = 0;
+    typedef typename _::Chunks<typename Container::const_iterator> Chunks;
+    Chunks const chunks = _::chunk(this->input, kSize);
+    for (typename Chunks::const_iterator i = chunks.begin();
+        i != chunks.end();
+        ++i) {
+      sum += key_of(*(*i).begin());
+    }
+    keep(sum);
+  }
+
+  void baseline() {
+    long long sum = 0;
+    std::size_t index = 0;
+    for (typename Container::const_iterator i = this->input.begin();
+        i != this->input.end();
+        ++i, ++index) {
+      if (index % kSize == 0) {
+        sum += key_of(*i);
+      }
+    }
+    keep(sum);
+  }
+};
+UNDERSCORE_BENCHMARK(Chunk, "chunk");
+
+template<typename Container>
+struct SlidingWindow : Case<Container> {
+  using Case<Container>::Case;
+
+  static std::size_t const kSize = 8;
+
+  void underscore() {
+    long long sum = 0;
+    typedef typename _::SlidingWindows<typename Container::const_iterator>
+        Windows;
+    Windows const windows = _::sliding_window(this->input, kSize);
+    for (typename Windows::const_iterator i = windows.begin();
+        i != windows.end();
+        ++i) {
+      sum += key_of(*(*i).begin());
+    }
+    keep(sum);
+  }
+
+  void baseline() {
+    long long sum = 0;
+    std::size_t const count = this->input.size();
+    std::size_t index = 0;
+    for (typename Container::const_iterator i = this->input.begin();
+        index + kSize <= count;
+        ++i, ++index) {
+      sum += key_of(*i);
+    }
+    keep(sum);
+  }
+};
+UNDERSCORE_BENCHMARK(SlidingWindow, "sliding_window");
+
+template<typename Container>
+struct Compact : Case<Container> {
+  typedef typename Container::value_type T;
+  static bool const applicable = ElementTraits<T>::is_arithmetic;
+  using Case<Container>::Case;
+
+  void underscore() {
+    keep(_::compact<std::vector<T> >(this->input));
+  }
+
+  void baseline() {
+    std::vector<T> result;
+    for (typename Container::const_iterator i = this->input.begin();
+        i != this->input.end();
+        ++i) {
+      if (static_cast<bool>(*i)) {
+        result.push_back(*i);
+      }
+    }
+    keep(result);
+  }
+};
+UNDERSCORE_BENCHMARK(Compact, "compact");
+
+template<typename Container>
+struct CompactInPlace : Case<Container> {
+  typedef typename Container::value_type T;
+  static bool const applicable = ElementTraits<T>::is_arithmetic;
+  using Case<Container>::Case;
+
+  struct IsFalsy {
+    bool operator()(T const& value) const {
+      return !static_cast<bool>(value);
+    }
+  };
+
+  void underscore() {
+    Container copy(this->input);
+    _::compact_in_place(copy);
+    keep(copy);
+  }
+
+  void baseline() {
+    Container copy(this->input);
+    erase_matching(copy, IsFalsy());
+    keep(copy);
+  }
+};
+UNDERSCORE_BENCHMARK(CompactInPlace, "compact_in_place");
+
+// flatten would descend into the characters of strings.
+template<typename Container>
+struct Flatten : Case<Container> {
+  typedef typename Container::value_type T;
+  static bool const applicable = !ElementTraits<T>::is_string;
+  static std::size_t const kSize = 64;
+
+  explicit Flatten(Container const& input) : Case<Container>(input) {
+    typename Container::const_iterator i = input.begin();
+    while (i != input.end()) {
+      typename Container::const_iterator end = i;
+      for (std::size_t n = 0; n < kSize && end != input.end(); ++n) {
+        ++end;
+      }
+      nested.push_back(Container(i, end));
+      i = end;
+    }
+  }
+
+  void underscore() {
+    keep(_::flatten<std::vector<T> >(nested));
+  }
+
+  void baseline() {
+    std::vector<T> result;
+    for (typename std::vector<Container>::const_iterator i = nested.begin();
+        i != nested.end();
+        ++i) {
+      result.insert(result.end(), i->begin(), i->end());
+    }
+    keep(result);
+  }
+
+  std::vector<Container> nested;
+};
+UNDERSCORE_BENCHMARK(Flatten, "flatten");
+
+template<typename Container>
+struct Without : Case<Container> {
+  typedef typename Container::value_type T;
+  explicit Without(Container const& input)
+      : Case<Container>(input), value(make<T>(0)) {
+  }
+
+  void underscore() {
+    keep(_::without<std::vector<T> >(this->input, value));
+  }
+
+  void baseline() {
+    std::vector<T> result;
+    std::remove_copy(
+        this->input.begin(),
+        this->input.end(),
+        std::back_inserter(result),
+        value);
+    keep(result);
+  }
+
+  T value;
+};
+UNDERSCORE_BENCHMARK(Without, "without");
+
+template<typename Container>
+struct WithoutInPlace : Case<Container> {
+  typedef typename Container::value_type T;
+  explicit WithoutInPlace(Container const& input)
+      : Case<Container>(input), value(make<T>(0)) {
+  }
+
+  struct IsZero {
+    template<typename Value>
+    bool operator()(Value const& element) const {
+      return key_of(element) == 0;
+    }
+  };
+
+  void underscore() {
+    Container copy(this->input);
+    _::without_in_place(copy, value);
+    keep(copy);
+  }
+
+  void baseline() {
+    Container copy(this->input);
+    erase_matching(copy, IsZero());
+    keep(copy);
+  }
+
+  T value;
+};
+UNDERSCORE_BENCHMARK(WithoutInPlace, "without_in_place");
+
+// Without is_sorted, uniq compares every element with every kept one.
+template<typename Container>
+struct Uniq : Case<Container> {
+  typedef typename Container::value_type T;
+  static std::size_t const max_size = 10000;
+  using Case<Container>::Case;
+
+  void underscore() {
+    keep(_::uniq<std::vector<T> >(this->input));
+  }
+
+  void baseline() {
+    std::vector<T> result;
+    std::unordered_set<long long> seen;
+    for (typename Container::const_iterator i = this->input.begin();
+        i != this->input.end();
+        ++i) {
+      if (seen.insert(key_of(*i)).second) {
+        result.push_back(*i);
+      }
+    }
+    keep(result);
+  }
+};
+UNDERSCORE_BENCHMARK(Uniq, "uniq");
+
+template<typename Container>
+struct UniqSorted : Case<Container> {
+  typedef typename Container::value_type T;
+  static bool const applicable = ContainerTraits<Container>::is_ordered;
+  explicit UniqSorted(Container const& input)
+      : Case<Container>(input),
+        sorted(make_sorted_input<Container>(input.size())) {
+  }
+
+  void underscore() {
+    keep(_::uniq<std::vector<T> >(sorted, true));
+  }
+
+  void baseline() {
+    std::vector<T> result;
+    std::unique_copy(sorted.begin(), sorted.end(), std::back_inserter(result));
+    keep(result);
+  }
+
+  Container sorted;
+};
+UNDERSCORE_BENCHMARK(UniqSorted, "uniq(sorted)");
+
+template<typename Container>
+struct UniqInPlace : Case<Container> {
+  static bool const applicable = ContainerTraits<Container>::is_sequence;
+  explicit UniqInPlace(Container const& input)
+      : Case<Container>(input),
+        sorted(make_sorted_input<Container>(input.size())) {
+  }
+
+  void underscore() {
+    Container copy(sorted);
+    _::uniq_in_place(copy, true);
+    keep(copy);
+  }
+
+  void baseline() {
+    Container copy(sorted);
+    copy.erase(std::unique(copy.begin(), copy.end()), copy.end());
+    keep(copy);
+  }
+
+  Container sorted;
+};
+UNDERSCORE_BENCHMARK(UniqInPlace, "uniq_in_place(sorted)");
+
+// The baseline sorts copies of the inputs, unless they are sets, which are
+// already sorted.
+template<typename Container>
+struct SortedView {
+  explicit SortedView(Container const& container)
+      : values(container.begin(), container.end()) {
+    std::sort(values.begin(), values.end());
+  }
+
+  typename std::vector<typename Container::value_type>::const_iterator
+  begin() const {
+    return values.begin();
+  }
+
+  typename std::vector<typename Container::value_type>::const_iterator
+  end() const {
+    return values.end();
+  }
+
+  std::vector<typename Container::value_type> values;
+};
+
+template<typename T>
+struct SortedView<std::set<T> > {
+  explicit SortedView(std::set<T> const& container) : container(container) {
+  }
+
+  typename std::set<T>::const_iterator begin() const {
+    return container.begin();
+  }
+
+  typename std::set<T>::const_iterator end() const {
+    return container.end();
+  }
+
+  std::set<T> const& container;
+};
+
+struct SetUnion {
+  template<typename Input1, typename Input2, typename Output>
+  Output operator()(
+      Input1 first1,
+      Input1 last1,
+      Input2 first2,
+      Input2 last2,
+      Output output) const {
+    return std::set_union(first1, last1, first2, last2, output);
+  }
+};
+
+struct SetIntersection {
+  template<typename Input1, typename Input2, typename Output>
+  Output operator()(
+      Input1 first1,
+      Input1 last1,
+      Input2 first2,
+      Input2 last2,
+      Output output) const {
+    return std::set_intersection(first1, last1, first2, last2, output);
+  }
+};
+
+struct SetDifference {
+  template<typename Input1, typename Input2, typename Output>
+  Output operator()(
+      Input1 first1,
+      Input1 last1,
+      Input2 first2,
+      Input2 last2,
+      Output output) const {
+    return std::set_difference(first1, last1, first2, last2, output);
+  }
+};
+
+template<typename Container, typename Operation>
+std::vector<typename Container::value_type> sorted_set_operation(
+    Container const& left,
+    Container const& right) {
+  SortedView<Container> const sorted_left(left);
+  SortedView<Container> const sorted_right(right);
+  std::vector<typename Container::value_type> result;
+  Operation()(
+      sorted_left.begin(),
+      sorted_left.end(),
+      sorted_right.begin(),
+      sorted_right.end(),
+      std::back_inserter(result));
+  return result;
+}
+
+template<typename Container>
+struct UnionOf : Paired<Container> {
+  typedef typename Container::value_type T;
+  using Paired<Container>::Paired;
+
+  void underscore() {
+    keep(_::union_of<std::vector<T> >(this->input, this->other));
+  }
+
+  void baseline() {
+    keep(sorted_set_operation<Container, SetUnion>(this->input, this->other));
+  }
+};
+UNDERSCORE_BENCHMARK(UnionOf, "union_of");
+
+template<typename Container>
+struct Intersection : Paired<Container> {
+  typedef typename Container::value_type T;
+  using Paired<Container>::Paired;
+
+  void underscore() {
+    keep(_::intersection<std::vector<T> >(this->input, this->other));
+  }
+
+  void baseline() {
+    keep(sorted_set_operation<Container, SetIntersection>(
+        this->input,
+        this->other));
+  }
+};
+UNDERSCORE_BENCHMARK(Intersection, "intersection");
+
+template<typename Container>
+struct Difference : Paired<Container> {
+  typedef typename Container::value_type T;
+  using Paired<Container>::Paired;
+
+  void underscore() {
+    keep(_::difference<std::vector<T> >(this->input, this->other));
+  }
+
+  void baseline() {
+    keep(sorted_set_operation<Container, SetDifference>(
+        this->input,
+        this->other));
+  }
+};
+UNDERSCORE_BENCHMARK(Difference, "difference");
+
+struct CountPairs {
+  explicit CountPairs(std::size_t* count) : count(count) {
+  }
+
+  template<typename Left, typename Right>
+  void operator()(Left const&, Right const&) const {
+    ++*count;
+  }
+
+  std::size_t* count;
+};
+
+// The baseline for the joins is the usual hand-written hash join over a
+// std::unordered_multimap.
+template<typename Container>
+std::size_t hash_join(Container const& left, Container const& right) {
+  typedef typename Container::value_type T;
+  std::unordered_multimap<long long, T const*> table;
+  table.reserve(right.size());
+  for (typename Container::const_iterator i = right.begin();
+      i != right.end();
+      ++i) {
+    table.insert(std::make_pair(key_of(*i), &*i));
+  }
+  std::size_t count = 0;
+  for (typename Container::const_iterator i = left.begin();
+      i != left.end();
+      ++i) {
+    typedef typename std::unordered_multimap<long long, T const*>::
+        const_iterator Match;
+    std::pair<Match, Match> const matches = table.equal_range(key_of(*i));
+    for (Match match = matches.first; match != matches.second; ++match) {
+      CountPairs counter(&count);
+      counter(*i, *match->second);
+    }
+  }
+  return count;
+}
+
+template<typename Container>
+struct SortMergeJoin : Paired<Container> {
+  using Paired<Container>::Paired;
+
+  void underscore() {
+    std::size_t count = 0;
+    _::sort_merge_join<long long>(
+        this->input,
+        this->other,
+        Key(),
+        Key(),
+        CountPairs(&count));
+    keep(count);
+  }
+
+  void baseline() {
+    keep(hash_join(this->input, this->other));
+  }
+};
+UNDERSCORE_BENCHMARK(SortMergeJoin, "sort_merge_join");
+
+template<typename Container>
+struct Join : Paired<Container> {
+  using Paired<Container>::Paired;
+
+  void underscore() {
+    std::size_t count = 0;
+    _::join<long long>(
+        this->input,
+        this->other,
+        Key(),
+        Key(),
+        CountPairs(&count));
+    keep(count);
+  }
+
+  void baseline() {
+    keep(hash_join(this->input, this->other));
+  }
+};
+UNDERSCORE_BENCHMARK(Join, "join");
+
+struct CountUnmatched {
+  CountUnmatched(std::size_t* matched, std::size_t* unmatched)
+      : matched(matched), unmatched(unmatched) {
+  }
+
+  template<typename Left, typename Right>
+  void operator()(Left const&, Right const* right) const {
+    ++*(right ? matched : unmatched);
+  }
+
+  std::size_t* matched;
+  std::size_t* unmatched;
+};
+
+template<typename Container>
+struct LeftJoin : Paired<Container> {
+  typedef typename Container::value_type T;
+  using Paired<Container>::Paired;
+
+  void underscore() {
+    std::size_t matched = 0;
+    std::size_t unmatched = 0;
+    _::left_join<long long>(
+        this->input,
+        this->other,
+        Key(),
+        Key(),
+        CountUnmatched(&matched, &unmatched));
+    keep(matched + unmatched);
+  }
+
+  void baseline() {
+    std::unordered_multimap<long long, T const*> table;
+    table.reserve(this->other.size());
+    for (typename Container::const_iterator i = this->other.begin();
+        i != this->other.end();
+        ++i) {
+      table.insert(std::make_pair(key_of(*i), &*i));
+    }
+    std::size_t matched = 0;
+    std::size_t unmatched = 0;
+    CountUnmatched const sink(&matched, &unmatched);
+    for (typename Container::const_iterator i = this->input.begin();
+        i != this->input.end();
+        ++i) {
+      typedef typename std::unordered_multimap<long long, T const*>::
+          const_iterator Match;
+      std::pair<Match, Match> const matches = table.equal_range(key_of(*i));
+      if (matches.first == matches.second) {
+        sink(*i, static_cast<T const*>(0));
+      }
+      for (Match match = matches.first; match != matches.second; ++match) {
+        sink(*i, match->second);
+      }
+    }
+    keep(matched + unmatched);
+  }
+};
+UNDERSCORE_BENCHMARK(LeftJoin, "left_join");
+
+template<typename Container>
+struct SemiJoin : Paired<Container> {
+  typedef typename Container::value_type T;
+  using Paired<Container>::Paired;
+
+  void underscore() {
+    keep(_::semi_join<std::vector<T>, long long>(
+        this->input,
+        this->other,
+        Key(),
+        Key()));
+  }
+
+  void baseline() {
+    std::unordered_set<long long> keys;
+    keys.reserve(this->other.size());
+    for (typename Container::const_iterator i = this->other.begin();
+        i != this->other.end();
+        ++i) {
+      keys.insert(key_of(*i));
+    }
+    std::vector<T> result;
+    for (typename Container::const_iterator i = this->input.begin();
+        i != this->input.end();
+        ++i) {
+      if (keys.count(key_of(*i))) {
+        result.push_back(*i);
+      }
+    }
+    keep(result);
+  }
+};
+UNDERSCORE_BENCHMARK(SemiJoin, "semi_join");
+
+template<typename Container>
+struct AntiJoin : Paired<Container> {
+  typedef typename Container::value_type T;
+  using Paired<Container>::Paired;
+
+  void underscore() {
+    keep(_::anti_join<std::vector<T>, long long>(
+        this->input,
+        this->other,
+        Key(),
+        Key()));
+  }
+
+  void baseline() {
+    std::unordered_set<long long> keys;
+    keys.reserve(this->other.size());
+    for (typename Container::const_iterator i = this->other.begin();
+        i != this->other.end();
+        ++i) {
+      keys.insert(key_of(*i));
+    }
+    std::vector<T> result;
+    for (typename Container::const_iterator i = this->input.begin();
+        i != this->input.end();
+        ++i) {
+      if (!keys.count(key_of(*i))) {
+        result.push_back(*i);
+      }
+    }
+    keep(result);
+  }
+};
+UNDERSCORE_BENCHMARK(AntiJoin, "anti_join");
+
+template<typename Container>
+struct Zip : Case<Container> {
+  typedef typename Container::value_type T;
+  using Case<Container>::Case;
+
+  void underscore() {
+    keep(_::zip<std::vector<std::pair<T, T> > >(this->input, this->input));
+  }
+
+  void baseline() {
+    std::vector<std::pair<T, T> > result;
+    result.reserve(this->input.size());
+    for (typename Container::const_iterator i = this->input.begin();
+        i != this->input.end();
+        ++i) {
+      result.push_back(std::make_pair(*i, *i));
+    }
+    keep(result);
+  }
+};
+UNDERSCORE_BENCHMARK(Zip, "zip");
+
+// The searches look for a value that isn't there, so every element is
+// visited.
+template<typename Container>
+struct IndexOf : Case<Container> {
+  typedef typename Container::value_type T;
+  explicit IndexOf(Container const& input)
+      : Case<Container>(input), data(input), missing(make<T>(-1)) {
+  }
+
+  void underscore() {
+    keep(_::index_of(data, missing));
+  }
+
+  void baseline() {
+    Container const& searched = data;
+    typename Container::const_iterator const found =
+        std::find(searched.begin(), searched.end(), missing);
+    keep(found == searched.end() ?
+        -1 :
+        std::distance(searched.begin(), found));
+  }
+
+  Container data;
+  T missing;
+};
+UNDERSCORE_BENCHMARK(IndexOf, "index_of");
+
+template<typename Container>
+struct LastIndexOf : Case<Container> {
+  typedef typename Container::value_type T;
+  static bool const applicable = ContainerTraits<Container>::is_ordered;
+  explicit LastIndexOf(Container const& input)
+      : Case<Container>(input), missing(make<T>(-1)) {
+  }
+
+  void underscore() {
+    keep(_::last_index_of(this->input, missing));
+  }
+
+  void baseline() {
+    typedef typename Container::const_reverse_iterator Reverse;
+    Reverse const found =
+        std::find(this->input.rbegin(), this->input.rend(), missing);
+    keep(found == this->input.rend() ?
+        -1 :
+        std::distance(found, this->input.rend()) - 1);
+  }
+
+  T missing;
+};
+UNDERSCORE_BENCHMARK(LastIndexOf, "last_index_of");
+
+// range doesn't take a container, so it only runs once per size.
+template<typename Container>
+struct Range : Case<Container> {
+  static bool const applicable =
+      std::is_same<Container, std::vector<int> >::value;
+  using Case<Container>::Case;
+
+  void underscore() {
+    keep(_::range<std::vector<int> >(static_cast<int>(this->input.size())));
+  }
+
+  void baseline() {
+    std::vector<int> result(this->input.size());
+    for (std::size_t i = 0; i < result.size(); ++i) {
+      result[i] = static_cast<int>(i);
+    }
+    keep(result);
+  }
+};
+UNDERSCORE_BENCHMARK(Range, "range");
+
+}  // namespace
+}  // namespace benchmarks
@@ -0,0 +1,721 @@
+// Benchmarks for the Collections functions and chaining.
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "harness.h"
+
+namespace benchmarks {
+namespace {
+
+struct SumKeys {
+  explicit SumKeys(long long* sum) : sum(sum) {
+  }
+
+  template<typename T>
+  void operator()(T const& value) const {
+    *sum += key_of(value);
+  }
+
+  long long* sum;
+};
+
+template<typename Container>
+struct Each : Case<Container> {
+  using Case<Container>::Case;
+
+  void underscore() {
+    long long sum = 0;
+    _::each(this->input, SumKeys(&sum));
+    keep(sum);
+  }
+
+  void baseline() {
+    long long sum = 0;
+    for (typename Container::const_iterator i = this->input.begin();
+        i != this->input.end();
+        ++i) {
+      sum += key_of(*i);
+    }
+    keep(sum);
+  }
+};
+UNDERSCORE_BENCHMARK(Each, "each");
+
+template<typename Container>
+struct Map : Case<Container> {
+  typedef typename Container::value_type T;
+  using Case<Container>::Case;
+
+  void underscore() {
+    keep(_::map<std::vector<T> >(this->input, Transform()));
+  }
+
+  void baseline() {
+    std::vector<T> result;
+    result.reserve(this->input.size());
+    std::transform(
+        this->input.begin(),
+        this->input.end(),
+        std::back_inserter(result),
+        Transform());
+    keep(result);
+  }
+};
+UNDERSCORE_BENCHMARK(Map, "map");
+
+template<typename Container>
+struct Reduce : Case<Container> {
+  using Case<Container>::Case;
+
+  void underscore() {
+    keep(_::reduce(this->input, AddKey(), 0LL));
+  }
+
+  void baseline() {
+    keep(std::accumulate(
+        this->input.begin(),
+        this->input.end(),
+        0LL,
+        AddKey()));
+  }
+};
+UNDERSCORE_BENCHMARK(Reduce, "reduce");
+
+template<typename Container>
+struct ReduceRight : Case<Container> {
+  static bool const applicable = ContainerTraits<Container>::is_ordered;
+  using Case<Container>::Case;
+
+  void underscore() {
+    keep(_::reduce_right(this->input, AddKey(), 0LL));
+  }
+
+  void baseline() {
+    keep(std::accumulate(
+        this->input.rbegin(),
+        this->input.rend(),
+        0LL,
+        AddKey()));
+  }
+};
+UNDERSCORE_BENCHMARK(ReduceRight, "reduce_right");
+
+template<typename Container>
+struct Scan : Case<Container> {
+  using Case<Container>::Case;
+
+  void underscore() {
+    keep(_::scan<std::vector<long long> >(this->input, Plus(), 0LL, Key()));
+  }
+
+  void baseline() {
+    std::vector<long long> result;
+    result.reserve(this->input.size());
+    long long memo = 0;
+    for (typename Container::const_iterator i = this->input.begin();
+        i != this->input.end();
+        ++i) {
+      memo += key_of(*i);
+      result.push_back(memo);
+    }
+    keep(result);
+  }
+};
+UNDERSCORE_BENCHMARK(Scan, "scan");
+
+// Into a buffer sized once up front, as a caller reusing it would.
+template<typename Container>
+struct ScanTo : Case<Container> {
+  explicit ScanTo(Container const& input)
+      : Case<Container>(input), output(input.size()) {
+  }
+
+  void underscore() {
+    keep(_::scan_to(this->input, output.begin(), Plus(), 0LL, Key()));
+  }
+
+  void baseline() {
+    std::vector<long long>::iterator out = output.begin();
+    long long memo = 0;
+    for (typename Container::const_iterator i = this->input.begin();
+        i != this->input.end();
+        ++i) {
+      memo += key_of(*i);
+      *out++ = memo;
+    }
+    keep(out);
+  }
+
+  std::vector<long long> output;
+};
+UNDERSCORE_BENCHMARK(ScanTo, "scan_to");
+
+template<typename Container>
+struct ExclusiveScan : Case<Container> {
+  using Case<Container>::Case;
+
+  void underscore() {
+    keep(_::exclusive_scan<std::vector<long long> >(
+        this->input,
+        Plus(),
+        0LL,
+        Key()));
+  }
+
+  void baseline() {
+    std::vector<long long> result;
+    result.reserve(this->input.size());
+    long long memo = 0;
+    for (typename Container::const_iterator i = this->input.begin();
+        i != this->input.end();
+        ++i) {
+      result.push_back(memo);
+      memo += key_of(*i);
+    }
+    keep(result);
+  }
+};
+UNDERSCORE_BENCHMARK(ExclusiveScan, "exclusive_scan");
+
+// The in-place cases copy the input on every run, in both versions.
+template<typename Container>
+struct ScanInPlace : Case<Container> {
+  static bool const applicable = ContainerTraits<Container>::is_sequence;
+  using Case<Container>::Case;
+
+  void underscore() {
+    Container copy(this->input);
+    _::scan_in_place(copy, Combine());
+    keep(copy);
+  }
+
+  void baseline() {
+    Container copy(this->input);
+    std::partial_sum(copy.begin(), copy.end(), copy.begin(), Combine());
+    keep(copy);
+  }
+};
+UNDERSCORE_BENCHMARK(ScanInPlace, "scan_in_place");
+
+template<typename Container>
+struct ScanInPlaceParallel : Case<Container> {
+  static bool const applicable = ContainerTraits<Container>::is_random_access;
+  using Case<Container>::Case;
+
+  void underscore() {
+    Container copy(this->input);
+    _::scan_in_place_parallel(copy, Combine());
+    keep(copy);
+  }
+
+  void baseline() {
+    Container copy(this->input);
+    std::partial_sum(copy.begin(), copy.end(), copy.begin(), Combine());
+    keep(copy);
+  }
+};
+UNDERSCORE_BENCHMARK(ScanInPlaceParallel, "scan_in_place_parallel");
+
+template<typename Container>
+void exclusive_scan_copy(Container& copy) {
+  typedef typename Container::value_type T;
+  T memo = make<T>(0);
+  for (typename Container::iterator i = copy.begin(); i != copy.end(); ++i) {
+    T const next = Combine()(memo, *i);
+    *i = memo;
+    memo = next;
+  }
+}
+
+template<typename Container>
+struct ExclusiveScanInPlace : Case<Container> {
+  typedef typename Container::value_type T;
+  static bool const applicable = ContainerTraits<Container>::is_sequence;
+  using Case<Container>::Case;
+
+  void underscore() {
+    Container copy(this->input);
+    _::exclusive_scan_in_place(copy, Combine(), make<T>(0));
+    keep(copy);
+  }
+
+  void baseline() {
+    Container copy(this->input);
+    exclusive_scan_copy(copy);
+    keep(copy);
+  }
+};
+UNDERSCORE_BENCHMARK(ExclusiveScanInPlace, "exclusive_scan_in_place");
+
+template<typename Container>
+struct ExclusiveScanInPlaceParallel : Case<Container> {
+  typedef typename Container::value_type T;
+  static bool const applicable = ContainerTraits<Container>::is_random_access;
+  using Case<Container>::Case;
+
+  void underscore() {
+    Container copy(this->input);
+    _::exclusive_scan_in_place_parallel(copy, Combine(), make<T>(0));
+    keep(copy);
+  }
+
+  void baseline() {
+    Container copy(this->input);
+    exclusive_scan_copy(copy);
+    keep(copy);
+  }
+};
+UNDERSCORE_BENCHMARK(
+    ExclusiveScanInPlaceParallel,
+    "exclusive_scan_in_place_parallel");
+
+// Searches for a key that isn't there, so every element is visited.
+template<typename Container>
+struct Find : Case<Container> {
+  explicit Find(Container const& input) : Case<Container>(input), data(input) {
+  }
+
+  struct IsMissing {
+    explicit IsMissing(long long missing) : missing(missing) {
+    }
+
+    template<typename T>
+    bool operator()(T const& value) const {
+      return key_of(value) == missing;
+    }
+
+    long long missing;
+  };
+
+  void underscore() {
+    keep(_::find(data, IsMissing(-1)) == data.end());
+  }
+
+  void baseline() {
+    keep(std::find_if(data.begin(), data.end(), IsMissing(-1)) == data.end());
+  }
+
+  Container data;
+};
+UNDERSCORE_BENCHMARK(Find, "find");
+
+// The same missing key, searched for by every worker against one core.
+template<typename Container>
+struct FindParallel : Case<Container> {
+  typedef typename Find<Container>::IsMissing IsMissing;
+  static bool const applicable = ContainerTraits<Container>::is_random_access;
+
+  explicit FindParallel(Container const& input)
+      : Case<Container>(input), data(input) {
+  }
+
+  void underscore() {
+    keep(_::find_parallel(data, IsMissing(-1)) == data.end());
+  }
+
+  void baseline() {
+    keep(std::find_if(data.begin(), data.end(), IsMissing(-1)) == data.end());
+  }
+
+  Container data;
+};
+UNDERSCORE_BENCHMARK(FindParallel, "find_parallel");
+
+template<typename Container>
+struct Filter : Case<Container> {
+  typedef typename Container::value_type T;
+  using Case<Container>::Case;
+
+  void underscore() {
+    keep(_::filter<std::vector<T> >(this->input, IsEven()));
+  }
+
+  void baseline() {
+    std::vector<T> result;
+    std::copy_if(
+        this->input.begin(),
+        this->input.end(),
+        std::back_inserter(result),
+        IsEven());
+    keep(result);
+  }
+};
+UNDERSCORE_BENCHMARK(Filter, "filter");
+
+template<typename Container>
+struct FilterInPlace : Case<Container> {
+  using Case<Container>::Case;
+
+  struct IsOdd {
+    template<typename T>
+    bool operator()(T const& value) const {
+      return key_of(value) % 2 != 0;
+    }
+  };
+
+  void underscore() {
+    Container copy(this->input);
+    _::filter_in_place(copy, IsEven());
+    keep(copy);
+  }
+
+  void baseline() {
+    Container copy(this->input);
+    erase_matching(copy, IsOdd());
+    keep(copy);
+  }
+};
+UNDERSCORE_BENCHMARK(FilterInPlace, "filter_in_place");
+
+template<typename Container>
+struct Reject : Case<Container> {
+  typedef typename Container::value_type T;
+  using Case<Container>::Case;
+
+  void underscore() {
+    keep(_::reject<std::vector<T> >(this->input, IsEven()));
+  }
+
+  void baseline() {
+    std::vector<T> result;
+    std::remove_copy_if(
+        this->input.begin(),
+        this->input.end(),
+        std::back_inserter(result),
+        IsEven());
+    keep(result);
+  }
+};
+UNDERSCORE_BENCHMARK(Reject, "reject");
+
+template<typename Container>
+struct RejectInPlace : Case<Container> {
+  using Case<Container>::Case;
+
+  void underscore() {
+    Container copy(this->input);
+    _::reject_in_place(copy, IsEven());
+    keep(copy);
+  }
+
+  void baseline() {
+    Container copy(this->input);
+    erase_matching(copy, IsEven());
+    keep(copy);
+  }
+};
+UNDERSCORE_BENCHMARK(RejectInPlace, "reject_in_place");
+
+template<typename Container>
+struct All : Case<Container> {
+  using Case<Container>::Case;
+
+  void underscore() {
+    keep(_::all(this->input, IsNonNegative()));
+  }
+
+  void baseline() {
+    keep(std::all_of(this->input.begin(), this->input.end(), IsNonNegative()));
+  }
+};
+UNDERSCORE_BENCHMARK(All, "all");
+
+template<typename Container>
+struct Any : Case<Container> {
+  using Case<Container>::Case;
+
+  void underscore() {
+    keep(_::any(this->input, IsNegative()));
+  }
+
+  void baseline() {
+    keep(std::any_of(this->input.begin(), this->input.end(), IsNegative()));
+  }
+};
+UNDERSCORE_BENCHMARK(Any, "any");
+
+template<typename Container>
+struct Include : Case<Container> {
+  typedef typename Container::value_type T;
+  explicit Include(Container const& input)
+      : Case<Container>(input), missing(make<T>(-1)) {
+  }
+
+  void underscore() {
+    keep(_::include(this->input, missing));
+  }
+
+  void baseline() {
+    keep(std::find(this->input.begin(), this->input.end(), missing) !=
+        this->input.end());
+  }
+
+  T missing;
+};
+UNDERSCORE_BENCHMARK(Include, "include");
+
+// Only Large has a data member to pluck.
+template<typename Container>
+struct Pluck : Case<Container> {
+  typedef typename Container::value_type T;
+  static bool const applicable = std::is_same<T, Large>::value;
+  using Case<Container>::Case;
+
+  void underscore() {
+    keep(_::pluck<std::vector<long long> >(this->input, &Large::key));
+  }
+
+  void baseline() {
+    std::vector<long long> result;
+    result.reserve(this->input.size());
+    for (typename Container::const_iterator i = this->input.begin();
+        i != this->input.end();
+        ++i) {
+      result.push_back(i->key);
+    }
+    keep(result);
+  }
+};
+UNDERSCORE_BENCHMARK(Pluck, "pluck");
+
+// max and min take the container by value, so the iterator they return
+// isn't dereferenced.
+template<typename Container>
+struct Max : Case<Container> {
+  using Case<Container>::Case;
+
+  void underscore() {
+    keep(_::max(this->input));
+  }
+
+  void baseline() {
+    keep(*std::max_element(this->input.begin(), this->input.end()));
+  }
+};
+UNDERSCORE_BENCHMARK(Max, "max");
+
+template<typename Container>
+struct Min : Case<Container> {
+  using Case<Container>::Case;
+
+  void underscore() {
+    keep(_::min(this->input));
+  }
+
+  void baseline() {
+    keep(*std::min_element(this->input.begin(), this->input.end()));
+  }
+};
+UNDERSCORE_BENCHMARK(Min, "min");
+
+// The baseline sorts a copy of the container itself where it can, which
+// saves the intermediate vector.
+template<typename Container>
+typename std::enable_if<ContainerTraits<Container>::is_random_access>::type
+sort_copy(Container& copy) {
+  std::sort(copy.begin(), copy.end(), Less());
+}
+
+template<typename T>
+void sort_copy(std::list<T>& copy) {
+  copy.sort(Less());
+}
+
+template<typename T>
+void sort_copy(std::set<T>&) {
+}
+
+template<typename Container>
+struct SortBy : Case<Container> {
+  static bool const applicable = ContainerTraits<Container>::is_ordered;
+  using Case<Container>::Case;
+
+  void underscore() {
+    keep(_::sort_by(this->input, Less()));
+  }
+
+  void baseline() {
+    Container copy(this->input);
+    sort_copy(copy);
+    keep(copy);
+  }
+};
+UNDERSCORE_BENCHMARK(SortBy, "sort_by");
+
+template<typename Container>
+struct GroupBy : Case<Container> {
+  typedef typename Container::value_type T;
+  using Case<Container>::Case;
+
+  struct Bucket {
+    template<typename Value>
+    long long operator()(Value const& value) const {
+      return key_of(value) % 1024;
+    }
+  };
+
+  void underscore() {
+    keep(_::group_by<long long>(this->input, Bucket()));
+  }
+
+  void baseline() {
+    std::map<long long, std::vector<T> > groups;
+    for (typename Container::const_iterator i = this->input.begin();
+        i != this->input.end();
+        ++i) {
+      groups[Bucket()(*i)].push_back(*i);
+    }
+    keep(groups);
+  }
+};
+UNDERSCORE_BENCHMARK(GroupBy, "group_by");
+
+template<typename Container>
+struct SortedIndex : Case<Container> {
+  typedef typename Container::value_type T;
+  static bool const applicable = ContainerTraits<Container>::is_ordered;
+  explicit SortedIndex(Container const& input)
+      : Case<Container>(input),
+        sorted(make_sorted_input<Container>(input.size())),
+        value(make<T>(static_cast<long long>(input.size() / 4))) {
+  }
+
+  void underscore() {
+    keep(_::sorted_index(sorted, value));
+  }
+
+  void baseline() {
+    keep(std::upper_bound(sorted.begin(), sorted.end(), value));
+  }
+
+  Container sorted;
+  T value;
+};
+UNDERSCORE_BENCHMARK(SortedIndex, "sorted_index");
+
+template<typename Container>
+struct Shuffle : Case<Container> {
+  typedef typename Container::value_type T;
+  using Case<Container>::Case;
+
+  void underscore() {
+    keep(_::shuffle<std::vector<T> >(this->input));
+  }
+
+  void baseline() {
+    std::vector<T> deck(this->input.begin(), this->input.end());
+    std::shuffle(deck.begin(), deck.end(), random);
+    keep(deck);
+  }
+
+  std::minstd_rand random;
+};
+UNDERSCORE_BENCHMARK(Shuffle, "shuffle");
+
+template<typename Container>
+struct ToArray : Case<Container> {
+  typedef typename Container::value_type T;
+  using Case<Container>::Case;
+
+  void underscore() {
+    T* array = _::to_array(this->input);
+    keep(array);
+    delete[] array;
+  }
+
+  void baseline() {
+    T* array = new T[this->input.size()];
+    std::copy(this->input.begin(), this->input.end(), array);
+    keep(array);
+    delete[] array;
+  }
+};
+UNDERSCORE_BENCHMARK(ToArray, "to_array");
+
+template<typename Container>
+struct Partition : Case<Container> {
+  typedef typename Container::value_type T;
+  using Case<Container>::Case;
+
+  void underscore() {
+    keep(_::partition<std::vector<T> >(this->input, IsEven()));
+  }
+
+  void baseline() {
+    std::pair<std::vector<T>, std::vector<T> > result;
+    std::partition_copy(
+        this->input.begin(),
+        this->input.end(),
+        std::back_inserter(result.first),
+        std::back_inserter(result.second),
+        IsEven());
+    keep(result);
+  }
+};
+UNDERSCORE_BENCHMARK(Partition, "partition");
+
+template<typename Container>
+struct PartitionInPlace : Case<Container> {
+  static bool const applicable = ContainerTraits<Container>::is_sequence;
+  using Case<Container>::Case;
+
+  void underscore() {
+    Container copy(this->input);
+    keep(_::partition_in_place(copy, IsEven()));
+  }
+
+  void baseline() {
+    Container copy(this->input);
+    keep(std::partition(copy.begin(), copy.end(), IsEven()));
+  }
+};
+UNDERSCORE_BENCHMARK(PartitionInPlace, "partition_in_place");
+
+template<typename Container>
+struct StablePartitionInPlace : Case<Container> {
+  static bool const applicable = ContainerTraits<Container>::is_sequence;
+  using Case<Container>::Case;
+
+  void underscore() {
+    Container copy(this->input);
+    keep(_::stable_partition_in_place(copy, IsEven()));
+  }
+
+  void baseline() {
+    Container copy(this->input);
+    keep(std::stable_partition(copy.begin(), copy.end(), IsEven()));
+  }
+};
+UNDERSCORE_BENCHMARK(StablePartitionInPlace, "stable_partition_in_place");
+
+template<typename Container>
+struct Chain : Case<Container> {
+  typedef typename Container::value_type T;
+  using Case<Container>::Case;
+
+  void underscore() {
+    keep(_::chain(this->input)
+        .template map<std::vector<T> >(Transform())
+        .reduce(AddKey(), 0LL)
+        .value());
+  }
+
+  void baseline() {
+    long long sum = 0;
+    for (typename Container::const_iterator i = this->input.begin();
+        i != this->input.end();
+        ++i) {
+      sum += key_of(Transform()(*i));
+    }
+    keep(sum);
+  }
+};
+UNDERSCORE_BENCHMARK(Chain, "chain");
+
+}  // namespace
+}  // namespace benchmarks
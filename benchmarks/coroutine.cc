@@ -0,0 +1,131 @@
+// Benchmarks for the coroutine layer, built as their own executable since
+// they need C++20. Both runs square the numbers below `size`, keep the even
+// ones and sum them: through generator map, filter and reduce, and through an
+// async_generator whose squaring stage runs on a ThreadPool behind buffer.
+// The baseline is the same loop written by hand, so ns/element is the cost of
+// a suspension per stage and, for buffer, of the queue between threads.
+
+#include <cstddef>
+#include <vector>
+
+#include "harness.h"
+#include "underscore/coroutine.h"
+
+namespace benchmarks {
+namespace {
+
+// measure() only needs the size of its input.
+struct Count {
+  std::size_t size() const {
+    return count;
+  }
+
+  std::size_t count;
+};
+
+long long square(long long value) {
+  return value * value;
+}
+
+bool is_even(long long value) {
+  return value % 2 == 0;
+}
+
+long long sum_by_hand(std::size_t size) {
+  long long sum = 0;
+  for (std::size_t i = 0; i < size; ++i) {
+    long long const value = square(static_cast<long long>(i));
+    if (is_even(value)) {
+      sum += value;
+    }
+  }
+  return sum;
+}
+
+_::generator<long long> count_to(std::size_t size) {
+  for (std::size_t i = 0; i < size; ++i) {
+    co_yield static_cast<long long>(i);
+  }
+}
+
+_::async_generator<long long> count_to_async(std::size_t size) {
+  for (std::size_t i = 0; i < size; ++i) {
+    co_yield static_cast<long long>(i);
+  }
+}
+
+void push(
+    Result result,
+    char const* implementation,
+    std::vector<Result>& results) {
+  result.implementation = implementation;
+  result.copies = -1;
+  results.push_back(result);
+}
+
+void run_generator(
+    std::size_t size,
+    Options const& options,
+    std::vector<Result>& results) {
+  Count const input = {size};
+  push(
+      measure(
+          input,
+          [size]() {
+            keep(_::reduce(
+                _::filter(_::map(count_to(size), square), is_even),
+                Plus(),
+                0LL));
+          },
+          options),
+      "underscore",
+      results);
+  push(
+      measure(input, [size]() { keep(sum_by_hand(size)); }, options),
+      "baseline",
+      results);
+}
+
+void run_buffer(
+    std::size_t size,
+    Options const& options,
+    std::vector<Result>& results) {
+  Count const input = {size};
+  _::ThreadPool pool;
+  push(
+      measure(
+          input,
+          [size, &pool]() {
+            keep(_::sync_wait(_::reduce(
+                _::filter(
+                    _::buffer(_::map(count_to_async(size), square), pool, 256),
+                    is_even),
+                Plus(),
+                0LL)));
+          },
+          options),
+      "underscore",
+      results);
+  push(
+      measure(input, [size]() { keep(sum_by_hand(size)); }, options),
+      "baseline",
+      results);
+}
+
+struct Registration {
+  Registration() {
+    Benchmark const benchmarks[] = {
+      {"generator", "generator", "long long", &run_generator},
+      {"buffer", "async_generator", "long long", &run_buffer}
+    };
+    registry().insert(
+        registry().end(),
+        benchmarks,
+        benchmarks + sizeof(benchmarks) / sizeof(benchmarks[0]));
+  }
+};
+
+Registration const registration;
+
+}  // namespace
+}  // namespace benchmarks
@@ -0,0 +1,113 @@
+// Benchmarks for the out-of-core sort_by and group_by. The memory budget is
+// 1 MB, so inputs past it spill sorted runs to temporary files. The baseline
+// is the in-memory version the functions stand in for: copy the input into a
+// vector, sort it and walk it. Only trivially copyable elements can be
+// written to disk, which leaves out strings and the counted copy runs.
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "harness.h"
+#include "underscore/external.h"
+
+namespace benchmarks {
+namespace {
+
+std::size_t const kMemoryBudget = 1 << 20;
+
+struct SumKeys {
+  explicit SumKeys(long long* sum) : sum(sum) {
+  }
+
+  template<typename T>
+  void operator()(T const& value) const {
+    *sum += key_of(value);
+  }
+
+  long long* sum;
+};
+
+struct CountGroups {
+  explicit CountGroups(std::size_t* groups) : groups(groups), last(-1) {
+  }
+
+  template<typename T>
+  void operator()(long long key, T const&) {
+    if (key != last) {
+      ++*groups;
+      last = key;
+    }
+  }
+
+  std::size_t* groups;
+  long long last;
+};
+
+template<typename Container>
+struct ExternalSortBy : Case<Container> {
+  typedef typename Container::value_type T;
+  static bool const applicable = std::is_trivially_copyable<T>::value;
+  using Case<Container>::Case;
+
+  void underscore() {
+    long long sum = 0;
+    _::external_sort_by(this->input, Less(), SumKeys(&sum), kMemoryBudget);
+    keep(sum);
+  }
+
+  void baseline() {
+    std::vector<T> sorted(this->input.begin(), this->input.end());
+    std::sort(sorted.begin(), sorted.end(), Less());
+    long long sum = 0;
+    std::for_each(sorted.begin(), sorted.end(), SumKeys(&sum));
+    keep(sum);
+  }
+};
+UNDERSCORE_BENCHMARK(ExternalSortBy, "external_sort_by");
+
+template<typename Container>
+struct ExternalGroupBy : Case<Container> {
+  typedef typename Container::value_type T;
+  static bool const applicable = std::is_trivially_copyable<T>::value;
+  using Case<Container>::Case;
+
+  void underscore() {
+    std::size_t groups = 0;
+    _::external_group_by<long long>(
+        this->input,
+        Key(),
+        CountGroups(&groups),
+        kMemoryBudget);
+    keep(groups);
+  }
+
+  void baseline() {
+    std::vector<std::pair<long long, T> > keyed;
+    keyed.reserve(this->input.size());
+    for (typename Container::const_iterator i = this->input.begin();
+        i != this->input.end();
+        ++i) {
+      keyed.push_back(std::make_pair(key_of(*i), *i));
+    }
+    std::stable_sort(
+        keyed.begin(),
+        keyed.end(),
+        [](std::pair<long long, T> const& left,
+            std::pair<long long, T> const& right) {
+          return left.first < right.first;
+        });
+    std::size_t groups = 0;
+    CountGroups count(&groups);
+    for (std::size_t i = 0; i < keyed.size(); ++i) {
+      count(keyed[i].first, keyed[i].second);
+    }
+    keep(groups);
+  }
+};
+UNDERSCORE_BENCHMARK(ExternalGroupBy, "external_group_by");
+
+}  // namespace
+}  // namespace benchmarks
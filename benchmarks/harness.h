@@ -0,0 +1,643 @@
+#ifndef UNDERSCORE_BENCHMARKS_HARNESS_H_
+#define UNDERSCORE_BENCHMARKS_HARNESS_H_
+
+// A small self-contained benchmark harness. Every benchmark case is a class
+// template over the container type with two member functions, `underscore`
+// and `baseline`, which do the same work with Underscore and with hand-written
+// standard library code. Each case is registered for every combination of
+// container and element type it applies to, and is measured at each of the
+// requested sizes for:
+//
+// * time, as nanoseconds per input element,
+// * heap bytes and allocations, counted by a replacement operator new, and
+// * element copies, counted by running the case once more over Counted<T>
+//   elements, whose copy constructor and assignment operator are counted.
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <list>
+#include <set>
+#include <string>
+#include <type_traits>
+#include <unordered_set>
+#include <vector>
+
+#include "underscore.h"
+
+namespace benchmarks {
+
+// Allocations
+
+struct AllocationCounters {
+  std::atomic<unsigned long long> bytes;
+  std::atomic<unsigned long long> count;
+};
+
+// Updated by the replacement operator new in main.cc.
+AllocationCounters& allocation_counters();
+
+// Elements
+
+// A 256 byte element, for measuring the cost of copies.
+struct Large {
+  long long key;
+  char payload[248];
+
+  bool operator<(Large const& other) const {
+    return key < other.key;
+  }
+
+  bool operator==(Large const& other) const {
+    return key == other.key;
+  }
+
+  bool operator!=(Large const& other) const {
+    return key != other.key;
+  }
+};
+
+inline unsigned long long& copy_count() {
+  static unsigned long long count = 0;
+  return count;
+}
+
+template<typename T>
+class Counted {
+ public:
+  Counted() : value_() {
+  }
+
+  explicit Counted(T const& value) : value_(value) {
+  }
+
+  Counted(Counted const& other) : value_(other.value_) {
+    ++copy_count();
+  }
+
+  Counted(Counted&& other) : value_(std::move(other.value_)) {
+  }
+
+  Counted& operator=(Counted const& other) {
+    value_ = other.value_;
+    ++copy_count();
+    return *this;
+  }
+
+  Counted& operator=(Counted&& other) {
+    value_ = std::move(other.value_);
+    return *this;
+  }
+
+  T const& value() const {
+    return value_;
+  }
+
+  explicit operator bool() const {
+    return static_cast<bool>(value_);
+  }
+
+  bool operator<(Counted const& other) const {
+    return value_ < other.value_;
+  }
+
+  bool operator==(Counted const& other) const {
+    return value_ == other.value_;
+  }
+
+  bool operator!=(Counted const& other) const {
+    return value_ != other.value_;
+  }
+
+ private:
+  T value_;
+};
+
+// Every element is generated from an integer key, which the functions used
+// by the cases (predicates, projections, join keys) work on.
+inline long long key_of(int value) {
+  return value;
+}
+
+inline long long key_of(double value) {
+  return static_cast<long long>(value);
+}
+
+// Strings are long enough to live on the heap, with the key in the last
+// digits.
+inline long long key_of(std::string const& value) {
+  long long key = 0;
+  for (std::size_t i = value.size() - 12; i < value.size(); ++i) {
+    key = key * 10 + (value[i] - '0');
+  }
+  return key;
+}
+
+inline long long key_of(Large const& value) {
+  return value.key;
+}
+
+template<typename T>
+long long key_of(Counted<T> const& value) {
+  return key_of(value.value());
+}
+
+template<typename T>
+struct Make;
+
+template<>
+struct Make<int> {
+  static int apply(long long key) {
+    return static_cast<int>(key);
+  }
+};
+
+template<>
+struct Make<double> {
+  static double apply(long long key) {
+    return static_cast<double>(key) + 0.5;
+  }
+};
+
+template<>
+struct Make<std::string> {
+  static std::string apply(long long key) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "underscore-%012lld", key);
+    return buffer;
+  }
+};
+
+template<>
+struct Make<Large> {
+  static Large apply(long long key) {
+    Large large;
+    large.key = key;
+    std::fill(large.payload, large.payload + sizeof(large.payload), 'x');
+    return large;
+  }
+};
+
+template<typename T>
+struct Make<Counted<T> > {
+  static Counted<T> apply(long long key) {
+    return Counted<T>(Make<T>::apply(key));
+  }
+};
+
+template<typename T>
+T make(long long key) {
+  return Make<T>::apply(key);
+}
+
+template<typename T>
+struct ElementTraits {
+  static bool const is_arithmetic = std::is_arithmetic<T>::value;
+  static bool const is_string = std::is_same<T, std::string>::value;
+};
+
+template<typename T>
+struct ElementTraits<Counted<T> > : ElementTraits<T> {
+};
+
+struct Hash {
+  template<typename T>
+  std::size_t operator()(T const& value) const {
+    return std::hash<long long>()(key_of(value));
+  }
+};
+
+// Containers
+
+template<typename T>
+using Vector = std::vector<T>;
+
+template<typename T>
+using List = std::list<T>;
+
+template<typename T>
+using Deque = std::deque<T>;
+
+template<typename T>
+using Set = std::set<T>;
+
+template<typename T>
+using UnorderedSet = std::unordered_set<T, Hash>;
+
+template<typename Container>
+struct ContainerTraits {
+  static bool const is_sequence = false;
+  static bool const is_random_access = false;
+  static bool const is_ordered = false;
+};
+
+template<typename T, typename Allocator>
+struct ContainerTraits<std::vector<T, Allocator> > {
+  static bool const is_sequence = true;
+  static bool const is_random_access = true;
+  static bool const is_ordered = true;
+};
+
+template<typename T, typename Allocator>
+struct ContainerTraits<std::deque<T, Allocator> > {
+  static bool const is_sequence = true;
+  static bool const is_random_access = true;
+  static bool const is_ordered = true;
+};
+
+template<typename T, typename Allocator>
+struct ContainerTraits<std::list<T, Allocator> > {
+  static bool const is_sequence = true;
+  static bool const is_random_access = false;
+  static bool const is_ordered = true;
+};
+
+template<typename T, typename Compare, typename Allocator>
+struct ContainerTraits<std::set<T, Compare, Allocator> > {
+  static bool const is_sequence = false;
+  static bool const is_random_access = false;
+  static bool const is_ordered = true;
+};
+
+// The keys 0 to size - 1 (plus an offset) in a scrambled order; the
+// multiplier is coprime with every power of ten, so no key repeats.
+template<typename Container>
+Container make_input(std::size_t size, long long offset = 0) {
+  Container container;
+  for (std::size_t i = 0; i < size; ++i) {
+    long long const key = static_cast<long long>(
+        (i * 2654435761ULL) % size);
+    container.insert(
+        container.end(),
+        make<typename Container::value_type>(key + offset));
+  }
+  return container;
+}
+
+// Sorted keys with every key appearing twice.
+template<typename Container>
+Container make_sorted_input(std::size_t size) {
+  Container container;
+  for (std::size_t i = 0; i < size; ++i) {
+    container.insert(
+        container.end(),
+        make<typename Container::value_type>(static_cast<long long>(i / 2)));
+  }
+  return container;
+}
+
+// Functions the cases pass to Underscore and use in their baselines.
+
+struct Transform {
+  template<typename T>
+  T operator()(T const& value) const {
+    return make<T>(key_of(value) + 1);
+  }
+};
+
+struct Combine {
+  template<typename T>
+  T operator()(T const& left, T const& right) const {
+    return make<T>(key_of(left) + key_of(right));
+  }
+};
+
+struct IsEven {
+  template<typename T>
+  bool operator()(T const& value) const {
+    return key_of(value) % 2 == 0;
+  }
+};
+
+struct IsNegative {
+  template<typename T>
+  bool operator()(T const& value) const {
+    return key_of(value) < 0;
+  }
+};
+
+struct IsNonNegative {
+  template<typename T>
+  bool operator()(T const& value) const {
+    return key_of(value) >= 0;
+  }
+};
+
+struct Key {
+  template<typename T>
+  long long operator()(T const& value) const {
+    return key_of(value);
+  }
+};
+
+struct AddKey {
+  template<typename T>
+  long long operator()(long long memo, T const& value) const {
+    return memo + key_of(value);
+  }
+};
+
+struct Plus {
+  long long operator()(long long left, long long right) const {
+    return left + right;
+  }
+};
+
+struct Less {
+  template<typename T>
+  bool operator()(T const& left, T const& right) const {
+    return left < right;
+  }
+};
+
+// Erases the matching elements the way hand-written code would for each
+// kind of container.
+template<typename Container, typename Predicate>
+typename std::enable_if<ContainerTraits<Container>::is_sequence>::type
+erase_matching(Container& container, Predicate predicate) {
+  container.erase(
+      std::remove_if(container.begin(), container.end(), predicate),
+      container.end());
+}
+
+template<typename Container, typename Predicate>
+typename std::enable_if<!ContainerTraits<Container>::is_sequence>::type
+erase_matching(Container& container, Predicate predicate) {
+  for (typename Container::iterator i = container.begin();
+      i != container.end();) {
+    if (predicate(*i)) {
+      i = container.erase(i);
+    } else {
+      ++i;
+    }
+  }
+}
+
+// Keeps the optimizer from discarding a result.
+template<typename T>
+void keep(T const& value) {
+#if defined(__GNUC__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static void const* volatile sink;
+  sink = &value;
+#endif
+}
+
+// Cases
+
+std::size_t const kUnlimited = static_cast<std::size_t>(-1);
+
+// The common base of the cases. `applicable` excludes the containers and
+// elements a function doesn't support, and `max_size` keeps the quadratic
+// functions to sizes that finish.
+template<typename Container>
+struct Case {
+  typedef Container container_type;
+  typedef typename Container::value_type T;
+
+  static bool const applicable = true;
+  static std::size_t const max_size = kUnlimited;
+
+  explicit Case(Container const& input) : input(input) {
+  }
+
+  Container const& input;
+};
+
+// Cases over two inputs, such as the set operations and joins, pair the input
+// with the same number of keys shifted by half, so half of each side matches.
+template<typename Container>
+struct Paired : Case<Container> {
+  explicit Paired(Container const& input)
+      : Case<Container>(input),
+        other(make_input<Container>(
+            input.size(),
+            static_cast<long long>(input.size() / 2))) {
+  }
+
+  Container other;
+};
+
+// Registration
+
+struct Result {
+  std::string function;
+  std::string container;
+  std::string element;
+  std::string implementation;
+  std::size_t size;
+  unsigned long long iterations;
+  double nanoseconds_per_element;
+  unsigned long long bytes;
+  unsigned long long allocations;
+  // Negative when the case can't count copies.
+  long long copies;
+};
+
+struct Options {
+  std::vector<std::size_t> sizes;
+  std::string filter;
+  double minimum_seconds;
+  unsigned long long maximum_bytes;
+};
+
+typedef void (*Runner)(
+    std::size_t size,
+    Options const& options,
+    std::vector<Result>& results);
+
+struct Benchmark {
+  std::string function;
+  std::string container;
+  std::string element;
+  Runner run;
+};
+
+std::vector<Benchmark>& registry();
+
+template<typename T>
+struct ElementName;
+
+template<>
+struct ElementName<int> {
+  static char const* get() {
+    return "int";
+  }
+};
+
+template<>
+struct ElementName<double> {
+  static char const* get() {
+    return "double";
+  }
+};
+
+template<>
+struct ElementName<std::string> {
+  static char const* get() {
+    return "string";
+  }
+};
+
+template<>
+struct ElementName<Large> {
+  static char const* get() {
+    return "large";
+  }
+};
+
+double seconds_since(unsigned long long start);
+unsigned long long now();
+
+template<typename Container, typename Function>
+Result measure(
+    Container const& input,
+    Function run,
+    Options const& options) {
+  Result result;
+  result.size = input.size();
+
+  AllocationCounters& counters = allocation_counters();
+  unsigned long long const bytes = counters.bytes.load();
+  unsigned long long const allocations = counters.count.load();
+  run();
+  result.bytes = counters.bytes.load() - bytes;
+  result.allocations = counters.count.load() - allocations;
+
+  unsigned long long iterations = 1;
+  for (;;) {
+    unsigned long long const start = now();
+    for (unsigned long long i = 0; i < iterations; ++i) {
+      run();
+    }
+    double const seconds = seconds_since(start);
+    if (seconds >= options.minimum_seconds || iterations >= (1ULL << 30)) {
+      result.iterations = iterations;
+      result.nanoseconds_per_element = seconds * 1e9 /
+          (static_cast<double>(iterations) *
+           static_cast<double>(std::max<std::size_t>(result.size, 1)));
+      return result;
+    }
+    iterations *= seconds < options.minimum_seconds / 16 ? 8 : 2;
+  }
+}
+
+template<typename Case>
+long long count_copies(
+    typename Case::container_type const& input,
+    void (Case::*implementation)()) {
+  Case instance(input);
+  copy_count() = 0;
+  (instance.*implementation)();
+  return static_cast<long long>(copy_count());
+}
+
+template<typename Plain, typename Counted, bool = Counted::applicable>
+struct CopyCounter {
+  static void apply(std::size_t size, std::vector<Result>& results) {
+    typename Counted::container_type const input =
+        make_input<typename Counted::container_type>(size);
+    results[results.size() - 2].copies =
+        count_copies<Counted>(input, &Counted::underscore);
+    results[results.size() - 1].copies =
+        count_copies<Counted>(input, &Counted::baseline);
+  }
+};
+
+template<typename Plain, typename Counted>
+struct CopyCounter<Plain, Counted, false> {
+  static void apply(std::size_t, std::vector<Result>&) {
+  }
+};
+
+template<typename Plain, typename Counted, bool = Plain::applicable>
+struct Measurement {
+  static void run(
+      std::size_t size,
+      Options const& options,
+      std::vector<Result>& results) {
+    typedef typename Plain::container_type Container;
+    if (size > Plain::max_size) {
+      return;
+    }
+    // The input, its counted copy and a result or two.
+    unsigned long long const estimated_bytes =
+        4ULL * size * (sizeof(typename Container::value_type) + 48);
+    if (estimated_bytes > options.maximum_bytes) {
+      return;
+    }
+
+    Container const input = make_input<Container>(size);
+    Plain instance(input);
+    Result underscore = measure(
+        input,
+        [&instance]() { instance.underscore(); },
+        options);
+    underscore.implementation = "underscore";
+    underscore.copies = -1;
+    results.push_back(underscore);
+    Result baseline = measure(
+        input,
+        [&instance]() { instance.baseline(); },
+        options);
+    baseline.implementation = "baseline";
+    baseline.copies = -1;
+    results.push_back(baseline);
+
+    CopyCounter<Plain, Counted>::apply(size, results);
+  }
+};
+
+template<typename Plain, typename Counted>
+struct Measurement<Plain, Counted, false> {
+  static void run(std::size_t, Options const&, std::vector<Result>&) {
+  }
+};
+
+template<template<typename> class Case,
+    template<typename> class Container,
+    typename T>
+void add(char const* function, char const* container) {
+  typedef Case<Container<T> > Plain;
+  if (!Plain::applicable) {
+    return;
+  }
+  Benchmark benchmark = {
+    function,
+    container,
+    ElementName<T>::get(),
+    &Measurement<Plain, Case<Container<Counted<T> > > >::run
+  };
+  registry().push_back(benchmark);
+}
+
+template<template<typename> class Case, typename T>
+void add_containers(char const* function) {
+  add<Case, Vector, T>(function, "vector");
+  add<Case, List, T>(function, "list");
+  add<Case, Deque, T>(function, "deque");
+  add<Case, Set, T>(function, "set");
+  add<Case, UnorderedSet, T>(function, "unordered_set");
+}
+
+template<template<typename> class Case>
+struct Registration {
+  explicit Registration(char const* function) {
+    add_containers<Case, int>(function);
+    add_containers<Case, double>(function);
+    add_containers<Case, std::string>(function);
+    add_containers<Case, Large>(function);
+  }
+};
+
+}  // namespace benchmarks
+
+// Registers a case template under the name of the function it measures.
+#define UNDERSCORE_BENCHMARK(Case, function) \
+  static ::benchmarks::Registration<Case> const Case##_registration(function)
+
+#endif  // UNDERSCORE_BENCHMARKS_HARNESS_H_
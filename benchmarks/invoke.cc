@@ -0,0 +1,192 @@
+// Benchmarks for invoke and invoke_grouped. invoke calls a member function on
+// every element of a vector of plain structs. invoke_grouped and
+// invoke_grouped_parallel call a virtual member function on a vector of
+// std::unique_ptr to three shape types in interleaved order, and the
+// baseline is the usual loop making the virtual call in container order. The
+// grouped runs reuse an InvokeGroupedBuffer, as a per-frame loop would.
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "harness.h"
+
+namespace benchmarks {
+namespace {
+
+struct Particle {
+  long long energy() const {
+    return mass * velocity * velocity / 2;
+  }
+
+  long long mass;
+  long long velocity;
+};
+
+struct Shape {
+  virtual ~Shape() {
+  }
+
+  virtual void update() = 0;
+
+  long long state;
+};
+
+struct Circle : Shape {
+  void update() {
+    state = state * 3 + 1;
+  }
+};
+
+struct Square : Shape {
+  void update() {
+    state = state * 5 + 2;
+  }
+};
+
+struct Triangle : Shape {
+  void update() {
+    state = state * 7 + 3;
+  }
+};
+
+typedef std::vector<std::unique_ptr<Shape> > Shapes;
+
+Shapes make_shapes(std::size_t size) {
+  Shapes shapes;
+  shapes.reserve(size);
+  for (std::size_t i = 0; i < size; ++i) {
+    switch ((i * 2654435761ULL) % 3) {
+      case 0:
+        shapes.emplace_back(new Circle);
+        break;
+      case 1:
+        shapes.emplace_back(new Square);
+        break;
+      default:
+        shapes.emplace_back(new Triangle);
+        break;
+    }
+    shapes.back()->state = static_cast<long long>(i);
+  }
+  return shapes;
+}
+
+void update_in_order(Shapes& shapes) {
+  for (Shapes::iterator i = shapes.begin(); i != shapes.end(); ++i) {
+    (*i)->update();
+  }
+}
+
+void push(
+    Result result,
+    char const* implementation,
+    std::vector<Result>& results) {
+  result.implementation = implementation;
+  result.copies = -1;
+  results.push_back(result);
+}
+
+void run_invoke(
+    std::size_t size,
+    Options const& options,
+    std::vector<Result>& results) {
+  std::vector<Particle> particles(size);
+  for (std::size_t i = 0; i < size; ++i) {
+    particles[i].mass = static_cast<long long>(i % 97);
+    particles[i].velocity = static_cast<long long>(i % 13);
+  }
+  push(
+      measure(
+          particles,
+          [&particles]() {
+            keep(_::invoke<std::vector<long long> >(
+                particles,
+                &Particle::energy));
+          },
+          options),
+      "underscore",
+      results);
+  push(
+      measure(
+          particles,
+          [&particles]() {
+            std::vector<long long> result;
+            result.reserve(particles.size());
+            for (std::vector<Particle>::const_iterator i = particles.begin();
+                i != particles.end();
+                ++i) {
+              result.push_back(i->energy());
+            }
+            keep(result);
+          },
+          options),
+      "baseline",
+      results);
+}
+
+void run_invoke_grouped(
+    std::size_t size,
+    Options const& options,
+    std::vector<Result>& results) {
+  Shapes shapes = make_shapes(size);
+  _::InvokeGroupedBuffer<Shape> buffer;
+  push(
+      measure(
+          shapes,
+          [&shapes, &buffer]() {
+            _::invoke_grouped(shapes, &Shape::update, buffer);
+          },
+          options),
+      "underscore",
+      results);
+  push(
+      measure(shapes, [&shapes]() { update_in_order(shapes); }, options),
+      "baseline",
+      results);
+}
+
+void run_invoke_grouped_parallel(
+    std::size_t size,
+    Options const& options,
+    std::vector<Result>& results) {
+  Shapes shapes = make_shapes(size);
+  _::InvokeGroupedBuffer<Shape> buffer;
+  push(
+      measure(
+          shapes,
+          [&shapes, &buffer]() {
+            _::invoke_grouped_parallel(shapes, &Shape::update, 0, buffer);
+          },
+          options),
+      "underscore",
+      results);
+  push(
+      measure(shapes, [&shapes]() { update_in_order(shapes); }, options),
+      "baseline",
+      results);
+}
+
+struct Registration {
+  Registration() {
+    Benchmark const benchmarks[] = {
+      {"invoke", "vector", "struct", &run_invoke},
+      {"invoke_grouped", "vector", "unique_ptr", &run_invoke_grouped},
+      {
+        "invoke_grouped_parallel",
+        "vector",
+        "unique_ptr",
+        &run_invoke_grouped_parallel
+      }
+    };
+    registry().insert(
+        registry().end(),
+        benchmarks,
+        benchmarks + sizeof(benchmarks) / sizeof(benchmarks[0]));
+  }
+};
+
+Registration const registration;
+
+}  // namespace
+}  // namespace benchmarks
@@ -0,0 +1,166 @@
+// Benchmarks for the live views. A container of `size` elements changes by
+// one element per tick, after which the sum, maximum, minimum, counts by key
+// and filtered elements are read again, as a dashboard would. The live views
+// are updated by the change; the baseline recomputes every result by hand.
+// Each run is 16 ticks and ns/element is the time per tick, so the baseline
+// grows with the size of the container and the live views don't.
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <map>
+#include <numeric>
+#include <unordered_set>
+#include <vector>
+
+#include "harness.h"
+#include "underscore/live.h"
+
+namespace benchmarks {
+namespace {
+
+std::size_t const kTicks = 16;
+
+struct Ticks {
+  std::size_t size() const {
+    return kTicks;
+  }
+};
+
+long long plus(long long sum, int value) {
+  return sum + value;
+}
+
+long long minus(long long sum, int value) {
+  return sum - value;
+}
+
+int bucket(int value) {
+  return value % 16;
+}
+
+bool is_even(int value) {
+  return value % 2 == 0;
+}
+
+typedef std::unordered_multiset<int> Container;
+
+// The values in the container, so that both implementations make the same
+// changes and each can pick an element to change in O(1).
+class Changes {
+ public:
+  explicit Changes(std::size_t size) : values_(size), next_(0) {
+    for (std::size_t i = 0; i < size; ++i) {
+      values_[i] = static_cast<int>((i * 2654435761ULL) % size);
+    }
+  }
+
+  Container container() const {
+    return Container(values_.begin(), values_.end());
+  }
+
+  // Picks an element and its new value, and remembers the new value.
+  void next(int& old_value, int& new_value) {
+    std::size_t const index = (next_++ * 7919) % values_.size();
+    old_value = values_[index];
+    new_value = static_cast<int>(
+        (static_cast<std::size_t>(old_value) * 31 + 7) %
+        (2 * values_.size()));
+    values_[index] = new_value;
+  }
+
+ private:
+  std::vector<int> values_;
+  std::size_t next_;
+};
+
+void run(
+    std::size_t size,
+    Options const& options,
+    std::vector<Result>& results) {
+  if (size == 0) {
+    return;
+  }
+  Ticks const ticks = Ticks();
+
+  Changes live_changes(size);
+  _::Live<Container> live = _::live(live_changes.container());
+  auto const& sum = live.reduce(plus, minus, 0LL);
+  auto const& max = live.max();
+  auto const& min = live.min();
+  auto const& counts = live.count_by<int>(bucket);
+  auto const& evens = live.filter<std::unordered_multiset<int> >(is_even);
+  Result underscore = measure(
+      ticks,
+      [&]() {
+        for (std::size_t tick = 0; tick < kTicks; ++tick) {
+          int old_value;
+          int new_value;
+          live_changes.next(old_value, new_value);
+          live.update(old_value, new_value);
+          keep(sum.value());
+          keep(max.value());
+          keep(min.value());
+          keep(counts.value().size());
+          keep(evens.value().size());
+        }
+      },
+      options);
+  underscore.size = size;
+  underscore.implementation = "underscore";
+  underscore.copies = -1;
+  results.push_back(underscore);
+
+  Changes baseline_changes(size);
+  Container container = baseline_changes.container();
+  Result baseline = measure(
+      ticks,
+      [&]() {
+        for (std::size_t tick = 0; tick < kTicks; ++tick) {
+          int old_value;
+          int new_value;
+          baseline_changes.next(old_value, new_value);
+          container.erase(container.find(old_value));
+          container.insert(new_value);
+          keep(std::accumulate(container.begin(), container.end(), 0LL));
+          keep(*std::max_element(container.begin(), container.end()));
+          keep(*std::min_element(container.begin(), container.end()));
+          std::map<int, std::size_t> counts;
+          for (Container::const_iterator i = container.begin();
+              i != container.end();
+              ++i) {
+            ++counts[bucket(*i)];
+          }
+          keep(counts.size());
+          std::vector<int> evens;
+          std::copy_if(
+              container.begin(),
+              container.end(),
+              std::back_inserter(evens),
+              is_even);
+          keep(evens.size());
+        }
+      },
+      options);
+  baseline.size = size;
+  baseline.implementation = "baseline";
+  baseline.copies = -1;
+  results.push_back(baseline);
+}
+
+struct Registration {
+  Registration() {
+    Benchmark benchmark = {
+      "live refresh",
+      "unordered_multiset",
+      "int",
+      &run
+    };
+    registry().push_back(benchmark);
+  }
+};
+
+Registration const registration;
+
+}  // namespace
+}  // namespace benchmarks
@@ -0,0 +1,242 @@
+// Runs the registered benchmarks and reports them as a table, and optionally
+// as JSON.
+//
+//   underscore_benchmarks [--filter=TEXT] [--sizes=N,N,...] [--min-time=S]
+//                         [--max-memory=BYTES] [--json=PATH] [--list]
+//
+// --filter keeps the benchmarks whose "function/container/element" name
+// contains TEXT. Sizes may be written like 1e6; the default is 100, 10000
+// and 1000000. Each measurement repeats until it has taken at least
+// --min-time seconds (0.05 by default). Combinations whose inputs would need
+// more than --max-memory bytes (2 GiB by default) are skipped, which is what
+// makes asking for sizes up to 1e8 practical.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "harness.h"
+
+namespace benchmarks {
+
+AllocationCounters& allocation_counters() {
+  static AllocationCounters counters;
+  return counters;
+}
+
+std::vector<Benchmark>& registry() {
+  static std::vector<Benchmark> benchmarks;
+  return benchmarks;
+}
+
+unsigned long long now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+double seconds_since(unsigned long long start) {
+  return static_cast<double>(now() - start) / 1e9;
+}
+
+namespace {
+
+bool starts_with(std::string const& text, char const* prefix) {
+  return text.compare(0, std::strlen(prefix), prefix) == 0;
+}
+
+std::vector<std::size_t> parse_sizes(std::string const& text) {
+  std::vector<std::size_t> sizes;
+  std::size_t begin = 0;
+  while (begin <= text.size()) {
+    std::size_t end = text.find(',', begin);
+    if (end == std::string::npos) {
+      end = text.size();
+    }
+    std::string const size = text.substr(begin, end - begin);
+    if (!size.empty()) {
+      sizes.push_back(static_cast<std::size_t>(
+          std::strtod(size.c_str(), 0)));
+    }
+    begin = end + 1;
+  }
+  return sizes;
+}
+
+void write_json(
+    std::ostream& output,
+    std::vector<Result> const& results) {
+  output << "{\n  \"benchmarks\": [";
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    Result const& result = results[i];
+    output << (i ? ",\n" : "\n")
+        << "    {\"function\": \"" << result.function
+        << "\", \"container\": \"" << result.container
+        << "\", \"element\": \"" << result.element
+        << "\", \"implementation\": \"" << result.implementation
+        << "\", \"size\": " << result.size
+        << ", \"iterations\": " << result.iterations
+        << ", \"ns_per_element\": " << result.nanoseconds_per_element
+        << ", \"bytes_allocated\": " << result.bytes
+        << ", \"allocations\": " << result.allocations
+        << ", \"copies\": ";
+    if (result.copies < 0) {
+      output << "null";
+    } else {
+      output << result.copies;
+    }
+    output << "}";
+  }
+  output << "\n  ]\n}\n";
+}
+
+void print_header() {
+  std::printf(
+      "%-24s %-14s %-7s %10s %12s %12s %8s %14s %14s %12s %12s\n",
+      "function",
+      "container",
+      "element",
+      "size",
+      "ns/elem",
+      "baseline",
+      "ratio",
+      "bytes",
+      "baseline",
+      "copies",
+      "baseline");
+}
+
+void print_pair(Result const& underscore, Result const& baseline) {
+  std::printf(
+      "%-24s %-14s %-7s %10zu %12.3f %12.3f %8.2f %14llu %14llu %12lld %12lld\n",
+      underscore.function.c_str(),
+      underscore.container.c_str(),
+      underscore.element.c_str(),
+      underscore.size,
+      underscore.nanoseconds_per_element,
+      baseline.nanoseconds_per_element,
+      baseline.nanoseconds_per_element > 0 ?
+          underscore.nanoseconds_per_element /
+              baseline.nanoseconds_per_element :
+          0.0,
+      underscore.bytes,
+      baseline.bytes,
+      underscore.copies,
+      baseline.copies);
+  std::fflush(stdout);
+}
+
+}  // namespace
+}  // namespace benchmarks
+
+// Every heap allocation in the process goes through these, so the bytes and
+// allocations of a run are the difference of the counters around it.
+void* operator new(std::size_t size) {
+  benchmarks::AllocationCounters& counters = benchmarks::allocation_counters();
+  counters.bytes.fetch_add(size, std::memory_order_relaxed);
+  counters.count.fetch_add(1, std::memory_order_relaxed);
+  void* memory = std::malloc(size ? size : 1);
+  if (!memory) {
+    throw std::bad_alloc();
+  }
+  return memory;
+}
+
+void* operator new[](std::size_t size) {
+  return operator new(size);
+}
+
+void operator delete(void* memory) noexcept {
+  std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+  std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+  std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept {
+  std::free(memory);
+}
+
+int main(int argc, char** argv) {
+  using namespace benchmarks;
+
+  Options options;
+  options.minimum_seconds = 0.05;
+  options.maximum_bytes = 2ULL << 30;
+  std::string json_path;
+  bool list = false;
+  for (int i = 1; i < argc; ++i) {
+    std::string const argument = argv[i];
+    if (starts_with(argument, "--filter=")) {
+      options.filter = argument.substr(9);
+    } else if (starts_with(argument, "--sizes=")) {
+      options.sizes = parse_sizes(argument.substr(8));
+    } else if (starts_with(argument, "--min-time=")) {
+      options.minimum_seconds = std::strtod(argument.c_str() + 11, 0);
+    } else if (starts_with(argument, "--max-memory=")) {
+      options.maximum_bytes = static_cast<unsigned long long>(
+          std::strtod(argument.c_str() + 13, 0));
+    } else if (starts_with(argument, "--json=")) {
+      json_path = argument.substr(7);
+    } else if (argument == "--list") {
+      list = true;
+    } else {
+      std::fprintf(stderr, "unknown argument: %s\n", argument.c_str());
+      return 2;
+    }
+  }
+  if (options.sizes.empty()) {
+    options.sizes.push_back(100);
+    options.sizes.push_back(10000);
+    options.sizes.push_back(1000000);
+  }
+
+  std::vector<Result> results;
+  if (!list) {
+    print_header();
+  }
+  for (std::size_t b = 0; b < registry().size(); ++b) {
+    Benchmark const& benchmark = registry()[b];
+    std::string const name = benchmark.function + "/" + benchmark.container +
+        "/" + benchmark.element;
+    if (name.find(options.filter) == std::string::npos) {
+      continue;
+    }
+    if (list) {
+      std::printf("%s\n", name.c_str());
+      continue;
+    }
+    for (std::size_t s = 0; s < options.sizes.size(); ++s) {
+      std::size_t const first = results.size();
+      benchmark.run(options.sizes[s], options, results);
+      for (std::size_t r = first; r < results.size(); ++r) {
+        results[r].function = benchmark.function;
+        results[r].container = benchmark.container;
+        results[r].element = benchmark.element;
+      }
+      if (results.size() == first + 2) {
+        print_pair(results[first], results[first + 1]);
+      }
+    }
+  }
+
+  if (!json_path.empty()) {
+    std::ofstream output(json_path.c_str());
+    if (!output) {
+      std::fprintf(stderr, "unable to write %s\n", json_path.c_str());
+      return 1;
+    }
+    write_json(output, results);
+  }
+  return 0;
+}
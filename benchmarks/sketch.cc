@@ -0,0 +1,122 @@
+// Benchmarks for the sketches. Each one summarizes the keys of the input and
+// answers one query, against the exact hand-written answer: a hash set for
+// distinct counts and membership, a hash map for frequencies and
+// std::nth_element for the median. The sketches trade accuracy for memory,
+// so the bytes column matters as much as the time.
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "harness.h"
+#include "underscore/sketch.h"
+
+namespace benchmarks {
+namespace {
+
+template<typename Container>
+std::unordered_set<long long> key_set(Container const& input) {
+  std::unordered_set<long long> keys;
+  keys.reserve(input.size());
+  for (typename Container::const_iterator i = input.begin();
+      i != input.end();
+      ++i) {
+    keys.insert(key_of(*i));
+  }
+  return keys;
+}
+
+template<typename Container>
+struct ApproxCountDistinct : Case<Container> {
+  using Case<Container>::Case;
+
+  void underscore() {
+    keep(_::approx_count_distinct<long long>(this->input, Key()));
+  }
+
+  void baseline() {
+    keep(key_set(this->input).size());
+  }
+};
+UNDERSCORE_BENCHMARK(ApproxCountDistinct, "approx_count_distinct");
+
+// Builds the filter and looks up every key once.
+template<typename Container>
+struct BloomFilter : Case<Container> {
+  using Case<Container>::Case;
+
+  void underscore() {
+    _::BloomFilter<long long> const filter =
+        _::bloom_filter<long long>(this->input, Key(), 0.01);
+    std::size_t found = 0;
+    for (typename Container::const_iterator i = this->input.begin();
+        i != this->input.end();
+        ++i) {
+      found += filter.contains(key_of(*i));
+    }
+    keep(found);
+  }
+
+  void baseline() {
+    std::unordered_set<long long> const keys = key_set(this->input);
+    std::size_t found = 0;
+    for (typename Container::const_iterator i = this->input.begin();
+        i != this->input.end();
+        ++i) {
+      found += keys.count(key_of(*i));
+    }
+    keep(found);
+  }
+};
+UNDERSCORE_BENCHMARK(BloomFilter, "bloom_filter");
+
+template<typename Container>
+struct CountMin : Case<Container> {
+  using Case<Container>::Case;
+
+  void underscore() {
+    keep(_::count_min<long long>(this->input, Key(), 0.001, 0.01).estimate(0));
+  }
+
+  void baseline() {
+    std::unordered_map<long long, unsigned long long> counts;
+    for (typename Container::const_iterator i = this->input.begin();
+        i != this->input.end();
+        ++i) {
+      ++counts[key_of(*i)];
+    }
+    keep(counts[0]);
+  }
+};
+UNDERSCORE_BENCHMARK(CountMin, "count_min");
+
+template<typename Container>
+struct QuantileSketch : Case<Container> {
+  using Case<Container>::Case;
+
+  void underscore() {
+    keep(_::quantile_sketch<long long>(this->input, Key(), 200).quantile(0.5));
+  }
+
+  void baseline() {
+    std::vector<long long> keys;
+    keys.reserve(this->input.size());
+    for (typename Container::const_iterator i = this->input.begin();
+        i != this->input.end();
+        ++i) {
+      keys.push_back(key_of(*i));
+    }
+    if (keys.empty()) {
+      return;
+    }
+    std::vector<long long>::iterator const middle =
+        keys.begin() + (keys.size() - 1) / 2;
+    std::nth_element(keys.begin(), middle, keys.end());
+    keep(*middle);
+  }
+};
+UNDERSCORE_BENCHMARK(QuantileSketch, "quantile_sketch");
+
+}  // namespace
+}  // namespace benchmarks
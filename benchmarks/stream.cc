@@ -0,0 +1,203 @@
+// Benchmarks for the file sources. Each run writes a temporary file to the
+// current directory, `size` long long records or `size` short lines, and
+// sums it with reduce over the source, opening it anew every iteration. The
+// baselines are the hand-written loops: fread into a buffer, and
+// std::getline on an std::ifstream. The file stays in the page cache, so
+// these measure the cost of the sources rather than of the disk.
+
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "harness.h"
+#include "underscore/stream.h"
+
+namespace benchmarks {
+namespace {
+
+// measure() only needs the size of its input.
+struct Count {
+  std::size_t size() const {
+    return count;
+  }
+
+  std::size_t count;
+};
+
+struct AddLength {
+  template<typename Line>
+  long long operator()(long long memo, Line const& line) const {
+    return memo + static_cast<long long>(line.size());
+  }
+};
+
+// Removes the file when the run is over, even if it throws.
+class TemporaryFile {
+ public:
+  explicit TemporaryFile(char const* path) : path_(path) {
+  }
+
+  ~TemporaryFile() {
+    std::remove(path_.c_str());
+  }
+
+  std::string const& path() const {
+    return path_;
+  }
+
+ private:
+  std::string path_;
+};
+
+void write_records(std::string const& path, std::size_t size) {
+  std::FILE* file = std::fopen(path.c_str(), "wb");
+  if (!file) {
+    throw std::runtime_error("Can't write " + path);
+  }
+  for (std::size_t i = 0; i < size; ++i) {
+    long long const record = static_cast<long long>(i);
+    std::fwrite(&record, sizeof(record), 1, file);
+  }
+  std::fclose(file);
+}
+
+void write_lines(std::string const& path, std::size_t size) {
+  std::ofstream file(path.c_str(), std::ios::binary);
+  for (std::size_t i = 0; i < size; ++i) {
+    file << "line " << i << '\n';
+  }
+  if (!file) {
+    throw std::runtime_error("Can't write " + path);
+  }
+}
+
+long long sum_records_by_hand(std::string const& path) {
+  std::FILE* file = std::fopen(path.c_str(), "rb");
+  std::vector<long long> buffer(4096);
+  long long sum = 0;
+  std::size_t count;
+  while ((count = std::fread(&buffer[0], sizeof(long long), 4096, file))) {
+    for (std::size_t i = 0; i < count; ++i) {
+      sum += buffer[i];
+    }
+  }
+  std::fclose(file);
+  return sum;
+}
+
+long long sum_lines_by_hand(std::string const& path) {
+  std::ifstream file(path.c_str(), std::ios::binary);
+  std::string line;
+  long long sum = 0;
+  while (std::getline(file, line)) {
+    sum += static_cast<long long>(line.size());
+  }
+  return sum;
+}
+
+void push(
+    Result result,
+    char const* implementation,
+    std::vector<Result>& results) {
+  result.implementation = implementation;
+  result.copies = -1;
+  results.push_back(result);
+}
+
+template<bool Mapped>
+void run_records(
+    std::size_t size,
+    Options const& options,
+    std::vector<Result>& results) {
+  if (size == 0) {
+    return;
+  }
+  TemporaryFile const file("underscore_benchmark.records");
+  write_records(file.path(), size);
+  Count const input = {size};
+  push(
+      measure(
+          input,
+          [&file]() {
+            if (Mapped) {
+              keep(_::reduce(
+                  _::mapped_records<long long>(file.path()),
+                  Plus(),
+                  0LL));
+            } else {
+              keep(_::reduce(
+                  _::record_file<long long>(file.path()),
+                  Plus(),
+                  0LL));
+            }
+          },
+          options),
+      "underscore",
+      results);
+  push(
+      measure(
+          input,
+          [&file]() { keep(sum_records_by_hand(file.path())); },
+          options),
+      "baseline",
+      results);
+}
+
+template<bool Mapped>
+void run_lines(
+    std::size_t size,
+    Options const& options,
+    std::vector<Result>& results) {
+  if (size == 0) {
+    return;
+  }
+  TemporaryFile const file("underscore_benchmark.lines");
+  write_lines(file.path(), size);
+  Count const input = {size};
+  push(
+      measure(
+          input,
+          [&file]() {
+            if (Mapped) {
+              keep(_::reduce(
+                  _::mapped_lines(file.path()),
+                  AddLength(),
+                  0LL));
+            } else {
+              keep(_::reduce(_::lines(file.path()), AddLength(), 0LL));
+            }
+          },
+          options),
+      "underscore",
+      results);
+  push(
+      measure(
+          input,
+          [&file]() { keep(sum_lines_by_hand(file.path())); },
+          options),
+      "baseline",
+      results);
+}
+
+struct Registration {
+  Registration() {
+    Benchmark const benchmarks[] = {
+      {"record_file", "file", "long long", &run_records<false>},
+      {"mapped_records", "file", "long long", &run_records<true>},
+      {"lines", "file", "line", &run_lines<false>},
+      {"mapped_lines", "file", "line", &run_lines<true>}
+    };
+    registry().insert(
+        registry().end(),
+        benchmarks,
+        benchmarks + sizeof(benchmarks) / sizeof(benchmarks[0]));
+  }
+};
+
+Registration const registration;
+
+}  // namespace
+}  // namespace benchmarks
@@ -0,0 +1,205 @@
+// Contention benchmarks for unique_id and Snowflake. Each run mints `size`
+// IDs split evenly across 1 to 64 threads, so ns/element is the wall-clock
+// cost per ID with that many threads minting at once. The baselines are the
+// usual hand-written versions: a shared std::atomic counter, snprintf of one
+// into a buffer, and a snowflake generator behind a std::mutex. Starting the
+// threads is part of every run, so sizes of 1e6 and up give the steadiest
+// numbers.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "harness.h"
+
+namespace benchmarks {
+namespace {
+
+// measure() only needs the size of its input.
+struct Count {
+  std::size_t size() const {
+    return count;
+  }
+
+  std::size_t count;
+};
+
+template<typename Mint>
+void mint_on_threads(unsigned threads, std::size_t count, Mint mint) {
+  std::size_t const each = count / threads;
+  std::vector<std::thread> workers;
+  workers.reserve(threads);
+  for (unsigned t = 0; t < threads; ++t) {
+    workers.emplace_back([each, mint]() mutable {
+      for (std::size_t i = 0; i < each; ++i) {
+        mint();
+      }
+    });
+  }
+  for (std::size_t t = 0; t < workers.size(); ++t) {
+    workers[t].join();
+  }
+}
+
+std::atomic<std::uint64_t>& shared_counter() {
+  static std::atomic<std::uint64_t> counter(1);
+  return counter;
+}
+
+struct UniqueId {
+  static char const* name() {
+    return "unique_id";
+  }
+
+  struct Underscore {
+    void operator()() {
+      keep(_::unique_id());
+    }
+  };
+
+  struct Baseline {
+    void operator()() {
+      keep(shared_counter().fetch_add(1, std::memory_order_relaxed));
+    }
+  };
+};
+
+struct PrefixedUniqueId {
+  static char const* name() {
+    return "unique_id(prefix)";
+  }
+
+  struct Underscore {
+    void operator()() {
+      keep(_::unique_id("request-", buffer));
+    }
+
+    char buffer[32];
+  };
+
+  struct Baseline {
+    void operator()() {
+      keep(std::snprintf(
+          buffer,
+          sizeof(buffer),
+          "request-%llu",
+          static_cast<unsigned long long>(
+              shared_counter().fetch_add(1, std::memory_order_relaxed))));
+    }
+
+    char buffer[32];
+  };
+};
+
+// The common hand-written generator: a mutex around the last timestamp and
+// sequence, borrowing the next millisecond when a sequence runs out.
+class LockedSnowflake {
+ public:
+  LockedSnowflake() : last_(0), sequence_(0) {
+  }
+
+  std::uint64_t next() {
+    std::uint64_t const now = static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count() -
+        1577836800000LL);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (now > last_) {
+      last_ = now;
+      sequence_ = 0;
+    } else if (++sequence_ == 4096) {
+      ++last_;
+      sequence_ = 0;
+    }
+    return last_ << 22 | 1 << 12 | sequence_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::uint64_t last_;
+  std::uint64_t sequence_;
+};
+
+struct SnowflakeId {
+  static char const* name() {
+    return "snowflake";
+  }
+
+  struct Underscore {
+    void operator()() {
+      static _::Snowflake<> generator(1);
+      keep(generator.next());
+    }
+  };
+
+  struct Baseline {
+    void operator()() {
+      static LockedSnowflake generator;
+      keep(generator.next());
+    }
+  };
+};
+
+template<typename Variant, unsigned Threads>
+void run(std::size_t size, Options const& options, std::vector<Result>& results) {
+  if (size < Threads) {
+    return;
+  }
+  Count const input = {size};
+  Result underscore = measure(
+      input,
+      [size]() {
+        mint_on_threads(Threads, size, typename Variant::Underscore());
+      },
+      options);
+  underscore.implementation = "underscore";
+  underscore.copies = -1;
+  results.push_back(underscore);
+  Result baseline = measure(
+      input,
+      [size]() {
+        mint_on_threads(Threads, size, typename Variant::Baseline());
+      },
+      options);
+  baseline.implementation = "baseline";
+  baseline.copies = -1;
+  results.push_back(baseline);
+}
+
+template<typename Variant, unsigned Threads>
+void add_threads(char const* threads) {
+  Benchmark benchmark = {
+    Variant::name(),
+    threads,
+    "id",
+    &run<Variant, Threads>
+  };
+  registry().push_back(benchmark);
+}
+
+template<typename Variant>
+void add_variant() {
+  add_threads<Variant, 1>("1 thread");
+  add_threads<Variant, 2>("2 threads");
+  add_threads<Variant, 4>("4 threads");
+  add_threads<Variant, 8>("8 threads");
+  add_threads<Variant, 16>("16 threads");
+  add_threads<Variant, 32>("32 threads");
+  add_threads<Variant, 64>("64 threads");
+}
+
+struct Registration {
+  Registration() {
+    add_variant<UniqueId>();
+    add_variant<PrefixedUniqueId>();
+    add_variant<SnowflakeId>();
+  }
+};
+
+Registration const registration;
+
+}  // namespace
+}  // namespace benchmarks
@@ -0,0 +1,121 @@
+// Underscore as a C++20 named module, for toolchains and build systems that
+// support modules (see UNDERSCORE_BUILD_MODULE in CMakeLists.txt), e.g.
+//
+//   import underscore;
+//
+//   std::vector<int> evens = _::filter<std::vector<int>>(numbers, is_even);
+//
+// The module is compiled once and its importers skip parsing and
+// instantiating the headers again. Only the public functions and classes are
+// exported. Modules don't export macros, so UNDERSCORE_INSTRUMENT has to be
+// defined when the module itself is built. The opt-in headers under
+// underscore/ are not part of the module and are still included as headers.
+
+module;
+
+#include "underscore.h"
+
+export module underscore;
+
+export namespace underscore {
+
+// Collections
+using underscore::InvokeGroupedBuffer;
+using underscore::all;
+using underscore::any;
+using underscore::collect;
+using underscore::contains;
+using underscore::detect;
+using underscore::detect_parallel;
+using underscore::each;
+using underscore::every;
+using underscore::exclusive_scan;
+using underscore::exclusive_scan_in_place;
+using underscore::exclusive_scan_in_place_parallel;
+using underscore::exclusive_scan_to;
+using underscore::filter;
+using underscore::filter_in_place;
+using underscore::find;
+using underscore::find_parallel;
+using underscore::foldl;
+using underscore::foldr;
+using underscore::for_each;
+using underscore::group_by;
+using underscore::include;
+using underscore::inclusive_scan;
+using underscore::inject;
+using underscore::invoke;
+using underscore::invoke_grouped;
+using underscore::invoke_grouped_parallel;
+using underscore::map;
+using underscore::max;
+using underscore::min;
+using underscore::pluck;
+using underscore::reduce;
+using underscore::reduce_right;
+using underscore::reject;
+using underscore::reject_in_place;
+using underscore::scan;
+using underscore::scan_in_place;
+using underscore::scan_in_place_parallel;
+using underscore::scan_to;
+using underscore::select;
+using underscore::select_in_place;
+using underscore::shuffle;
+using underscore::size;
+using underscore::some;
+using underscore::sort_by;
+using underscore::sorted_index;
+using underscore::to_array;
+
+// Arrays
+using underscore::Chunks;
+using underscore::Slice;
+using underscore::SlidingWindows;
+using underscore::anti_join;
+using underscore::chunk;
+using underscore::compact;
+using underscore::compact_in_place;
+using underscore::difference;
+using underscore::first;
+using underscore::flatten;
+using underscore::head;
+using underscore::index_of;
+using underscore::initial;
+using underscore::intersection;
+using underscore::join;
+using underscore::last;
+using underscore::last_index_of;
+using underscore::left_join;
+using underscore::partition;
+using underscore::partition_in_place;
+using underscore::range;
+using underscore::rest;
+using underscore::semi_join;
+using underscore::sliding_window;
+using underscore::sort_merge_join;
+using underscore::stable_partition_in_place;
+using underscore::tail;
+using underscore::union_of;
+using underscore::uniq;
+using underscore::uniq_in_place;
+using underscore::unique;
+using underscore::unique_in_place;
+using underscore::without;
+using underscore::without_in_place;
+using underscore::zip;
+
+// Utility
+using underscore::Identity;
+using underscore::Snowflake;
+using underscore::identity;
+using underscore::unique_id;
+
+// Chaining
+using underscore::Wrapper;
+using underscore::chain;
+using underscore::value;
+
+}  // namespace underscore
+
+export namespace _ = underscore;
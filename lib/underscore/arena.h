@@ -0,0 +1,63 @@
+#ifndef UNDERSCORE_ARENA_H_
+#define UNDERSCORE_ARENA_H_
+
+// A monotonic arena for per-request processing with the allocator-aware
+// overloads, e.g.
+//
+//   _::Arena<4096> arena;
+//   std::pmr::vector<int> evens = _::filter<std::pmr::vector<int> >(
+//       numbers, is_even, arena.allocator());
+//
+// Allocations are carved out of an inline buffer of Size bytes, and then out
+// of blocks taken from the upstream resource once that runs out. Nothing is
+// freed until the arena is released or destroyed, so allocating is a pointer
+// bump and there is no contention between threads using their own arenas.
+// Anything allocated from an arena must not outlive it.
+//
+// This header requires C++17.
+
+#include <cstddef>
+#include <memory_resource>
+
+#include "helper.h"
+
+namespace underscore {
+
+template<std::size_t Size>
+class Arena {
+ public:
+  Arena() : resource_(buffer_, Size) {
+  }
+
+  // Passing std::pmr::null_memory_resource() as the upstream makes
+  // exhausting the inline buffer throw std::bad_alloc instead of falling back
+  // to the heap.
+  explicit Arena(std::pmr::memory_resource* upstream)
+      : resource_(buffer_, Size, upstream) {
+  }
+
+  Arena(Arena const&) = delete;
+  Arena& operator=(Arena const&) = delete;
+
+  std::pmr::polymorphic_allocator<std::byte> allocator() {
+    return std::pmr::polymorphic_allocator<std::byte>(&resource_);
+  }
+
+  std::pmr::memory_resource* resource() {
+    return &resource_;
+  }
+
+  // Frees everything allocated from the arena at once, so it can be reused
+  // for the next request.
+  void release() {
+    resource_.release();
+  }
+
+ private:
+  alignas(std::max_align_t) std::byte buffer_[Size];
+  std::pmr::monotonic_buffer_resource resource_;
+};
+
+}  // namespace underscore
+
+#endif  // UNDERSCORE_ARENA_H_
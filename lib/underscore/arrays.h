@@ -0,0 +1,1839 @@
+#ifndef UNDERSCORE_ARRAYS_H_
+#define UNDERSCORE_ARRAYS_H_
+
+// Arrays: the functions that treat a container as a sequence, such as
+// first, chunk, uniq, the set operations and the joins.
+
+#include "collections.h"
+
+namespace underscore {
+
+// first/head
+template<typename Container>
+typename Container::iterator first(Container& container) {
+  return container.begin();
+}
+
+template<typename ResultContainer, typename Container>
+ResultContainer first(Container& container, int count) {
+  typename Container::iterator end = container.begin();
+  std::advance(end, count);
+  return ResultContainer(container.begin(), end);
+}
+
+template<typename ResultContainer, typename Container, typename Allocator>
+ResultContainer first(
+    Container& container,
+    int count,
+    Allocator const& allocator) {
+  typename Container::iterator end = container.begin();
+  std::advance(end, count);
+  ResultContainer result(allocator);
+  helper::append_range(result, container.begin(), end);
+  return result;
+}
+
+template<typename Container>
+typename Container::iterator head(Container& container) {
+  return first(container);
+}
+
+template<typename ResultContainer, typename Container>
+ResultContainer head(Container& container, int count) {
+  return first<ResultContainer>(container, count);
+}
+
+template<typename ResultContainer, typename Container, typename Allocator>
+ResultContainer head(
+    Container& container,
+    int count,
+    Allocator const& allocator) {
+  return first<ResultContainer>(container, count, allocator);
+}
+
+// initial
+template<typename ResultContainer, typename Container>
+ResultContainer initial(Container& container) {
+  typename Container::iterator end = container.begin();
+  std::advance(end, container.size() - 1);
+  return ResultContainer(container.begin(), end);
+}
+
+template<typename ResultContainer, typename Container>
+ResultContainer initial(Container& container, int n) {
+  typename Container::iterator end = container.begin();
+  std::advance(end, container.size() - n);
+  return ResultContainer(container.begin(), end);
+}
+
+template<typename ResultContainer, typename Container, typename Allocator>
+ResultContainer initial(
+    Container& container,
+    int n,
+    Allocator const& allocator) {
+  typename Container::iterator end = container.begin();
+  std::advance(end, container.size() - n);
+  ResultContainer result(allocator);
+  helper::append_range(result, container.begin(), end);
+  return result;
+}
+
+// last
+template<typename Container>
+typename Container::iterator last(Container& container) {
+  typename Container::iterator last = container.begin();
+  std::advance(last, container.size() - 1);
+  return last;
+}
+
+template<typename ResultContainer, typename Container>
+ResultContainer last(Container& container, int n) {
+  typename Container::iterator begin = container.begin();
+  std::advance(begin, container.size() - n);
+  return ResultContainer(begin, container.end());
+}
+
+template<typename ResultContainer, typename Container, typename Allocator>
+ResultContainer last(
+    Container& container,
+    int n,
+    Allocator const& allocator) {
+  typename Container::iterator begin = container.begin();
+  std::advance(begin, container.size() - n);
+  ResultContainer result(allocator);
+  helper::append_range(result, begin, container.end());
+  return result;
+}
+
+// rest/tail
+template<typename ResultContainer, typename Container>
+ResultContainer rest(Container& container) {
+  return ResultContainer(++container.begin(), container.end());
+}
+
+template<typename ResultContainer, typename Container>
+ResultContainer rest(Container& container, int index) {
+  typename Container::iterator begin = container.begin();
+  std::advance(begin, index);
+  return ResultContainer(begin, container.end());
+}
+
+template<typename ResultContainer, typename Container, typename Allocator>
+ResultContainer rest(
+    Container& container,
+    int index,
+    Allocator const& allocator) {
+  typename Container::iterator begin = container.begin();
+  std::advance(begin, index);
+  ResultContainer result(allocator);
+  helper::append_range(result, begin, container.end());
+  return result;
+}
+
+template<typename ResultContainer, typename Container>
+ResultContainer tail(Container& container) {
+  return rest<ResultContainer>(container);
+}
+
+template<typename ResultContainer, typename Container>
+ResultContainer tail(Container& container, int index) {
+  return rest<ResultContainer>(container, index);
+}
+
+template<typename ResultContainer, typename Container, typename Allocator>
+ResultContainer tail(
+    Container& container,
+    int index,
+    Allocator const& allocator) {
+  return rest<ResultContainer>(container, index, allocator);
+}
+
+// slice
+// A view over a subrange of another container. Slices are O(1) to create and
+// copy, and they expose the same interface as the standard containers, so a
+// slice can be passed to any Underscore function (or chained) in place of a
+// container. A slice is only valid as long as the range it views.
+template<typename Iterator>
+class Slice {
+ public:
+  typedef typename std::iterator_traits<Iterator>::value_type value_type;
+  typedef Iterator iterator;
+  typedef Iterator const_iterator;
+  typedef std::reverse_iterator<Iterator> reverse_iterator;
+  typedef std::reverse_iterator<Iterator> const_reverse_iterator;
+  typedef std::size_t size_type;
+
+  Slice(Iterator begin, Iterator end, size_type size)
+      : begin_(begin), end_(end), size_(size) {
+  }
+
+  Iterator begin() const {
+    return begin_;
+  }
+
+  Iterator end() const {
+    return end_;
+  }
+
+  reverse_iterator rbegin() const {
+    return reverse_iterator(end_);
+  }
+
+  reverse_iterator rend() const {
+    return reverse_iterator(begin_);
+  }
+
+  size_type size() const {
+    return size_;
+  }
+
+  bool empty() const {
+    return size_ == 0;
+  }
+
+ private:
+  Iterator begin_;
+  Iterator end_;
+  size_type size_;
+};
+
+namespace helper {
+template<typename Container>
+struct IteratorOf {
+  typedef typename Container::iterator type;
+};
+
+template<typename Container>
+struct IteratorOf<Container const> {
+  typedef typename Container::const_iterator type;
+};
+}  // namespace helper
+
+// chunk
+// Splits a container into consecutive slices of `size` elements; the last
+// slice holds whatever remains. Nothing is copied, so this is the way to feed
+// a container to a bulk API a fixed number of elements at a time.
+template<typename Iterator>
+class Chunks {
+ public:
+  typedef Slice<Iterator> value_type;
+  typedef std::size_t size_type;
+
+  class iterator {
+   public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef Slice<Iterator> value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef Slice<Iterator> const* pointer;
+    typedef Slice<Iterator> reference;
+
+    iterator(Iterator position, size_type remaining, size_type size)
+        : position_(position),
+          next_(position),
+          remaining_(remaining),
+          size_(size) {
+      std::advance(next_, std::min(size_, remaining_));
+    }
+
+    Slice<Iterator> operator*() const {
+      return Slice<Iterator>(position_, next_, std::min(size_, remaining_));
+    }
+
+    iterator& operator++() {
+      remaining_ -= std::min(size_, remaining_);
+      position_ = next_;
+      std::advance(next_, std::min(size_, remaining_));
+      return *this;
+    }
+
+    iterator operator++(int) {
+      iterator previous = *this;
+      ++*this;
+      return previous;
+    }
+
+    bool operator==(iterator const& other) const {
+      return remaining_ == other.remaining_;
+    }
+
+    bool operator!=(iterator const& other) const {
+      return !(*this == other);
+    }
+
+   private:
+    Iterator position_;
+    Iterator next_;
+    size_type remaining_;
+    size_type size_;
+  };
+  typedef iterator const_iterator;
+
+  Chunks(Iterator begin, Iterator end, size_type count, size_type size)
+      : begin_(begin), end_(end), count_(size ? count : 0), size_(size) {
+  }
+
+  iterator begin() const {
+    return iterator(begin_, count_, size_);
+  }
+
+  iterator end() const {
+    return iterator(end_, 0, size_);
+  }
+
+  size_type size() const {
+    return size_ ? (count_ + size_ - 1) / size_ : 0;
+  }
+
+  bool empty() const {
+    return count_ == 0;
+  }
+
+ private:
+  Iterator begin_;
+  Iterator end_;
+  size_type count_;
+  size_type size_;
+};
+
+template<typename Container>
+Chunks<typename helper::IteratorOf<Container>::type> chunk(
+    Container& container,
+    std::size_t size) {
+  return Chunks<typename helper::IteratorOf<Container>::type>(
+      container.begin(),
+      container.end(),
+      container.size(),
+      size);
+}
+
+// sliding_window
+// Every run of `size` consecutive elements, in order, as slices. A container
+// with fewer than `size` elements has no windows. Stepping from one window to
+// the next is O(1) for any kind of iterator.
+template<typename Iterator>
+class SlidingWindows {
+ public:
+  typedef Slice<Iterator> value_type;
+  typedef std::size_t size_type;
+
+  class iterator {
+   public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef Slice<Iterator> value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef Slice<Iterator> const* pointer;
+    typedef Slice<Iterator> reference;
+
+    iterator(Iterator first, Iterator last, size_type remaining, size_type size)
+        : first_(first), last_(last), remaining_(remaining), size_(size) {
+    }
+
+    Slice<Iterator> operator*() const {
+      return Slice<Iterator>(first_, last_, size_);
+    }
+
+    iterator& operator++() {
+      ++first_;
+      if (--remaining_) {
+        ++last_;
+      }
+      return *this;
+    }
+
+    iterator operator++(int) {
+      iterator previous = *this;
+      ++*this;
+      return previous;
+    }
+
+    bool operator==(iterator const& other) const {
+      return remaining_ == other.remaining_;
+    }
+
+    bool operator!=(iterator const& other) const {
+      return !(*this == other);
+    }
+
+   private:
+    Iterator first_;
+    Iterator last_;
+    size_type remaining_;
+    size_type size_;
+  };
+  typedef iterator const_iterator;
+
+  SlidingWindows(Iterator begin, Iterator end, size_type count, size_type size)
+      : begin_(begin),
+        end_(end),
+        windows_(size && count >= size ? count - size + 1 : 0),
+        size_(size) {
+  }
+
+  iterator begin() const {
+    Iterator last = begin_;
+    if (windows_) {
+      std::advance(last, size_);
+    }
+    return iterator(begin_, last, windows_, size_);
+  }
+
+  iterator end() const {
+    return iterator(end_, end_, 0, size_);
+  }
+
+  size_type size() const {
+    return windows_;
+  }
+
+  bool empty() const {
+    return windows_ == 0;
+  }
+
+ private:
+  Iterator begin_;
+  Iterator end_;
+  size_type windows_;
+  size_type size_;
+};
+
+template<typename Container>
+SlidingWindows<typename helper::IteratorOf<Container>::type> sliding_window(
+    Container& container,
+    std::size_t size) {
+  return SlidingWindows<typename helper::IteratorOf<Container>::type>(
+      container.begin(),
+      container.end(),
+      container.size(),
+      size);
+}
+
+// partition
+// A single stable pass that writes the elements matching the predicate to one
+// output and the rest to the other. The outputs are typically iterators into
+// buffers the caller has already sized; the advanced iterators are returned.
+template<typename Container,
+    typename Predicate,
+    typename MatchedIterator,
+    typename UnmatchedIterator>
+std::pair<MatchedIterator, UnmatchedIterator> partition(
+    Container const& container,
+    Predicate predicate,
+    MatchedIterator matched,
+    UnmatchedIterator unmatched) {
+  UNDERSCORE_PROFILE("partition", container);
+  for (typename Container::const_iterator i = container.begin();
+      i != container.end();
+      ++i) {
+    if (predicate(*i)) {
+      *matched++ = *i;
+    } else {
+      *unmatched++ = *i;
+    }
+  }
+  return std::make_pair(matched, unmatched);
+}
+
+template<typename ResultContainer, typename Container, typename Predicate>
+std::pair<ResultContainer, ResultContainer> partition(
+    Container const& container,
+    Predicate predicate) {
+  UNDERSCORE_PROFILE("partition", container);
+  std::pair<ResultContainer, ResultContainer> result;
+  for (typename Container::const_iterator i = container.begin();
+      i != container.end();
+      ++i) {
+    helper::add_to_container(
+        predicate(*i) ? result.first : result.second,
+        *i);
+  }
+  return result;
+}
+
+template<typename ResultContainer,
+    typename Container,
+    typename Predicate,
+    typename Allocator>
+std::pair<ResultContainer, ResultContainer> partition(
+    Container const& container,
+    Predicate predicate,
+    Allocator const& allocator) {
+  UNDERSCORE_PROFILE("partition", container);
+  std::pair<ResultContainer, ResultContainer> result(
+      (ResultContainer(allocator)),
+      (ResultContainer(allocator)));
+  for (typename Container::const_iterator i = container.begin();
+      i != container.end();
+      ++i) {
+    helper::add_to_container(
+        predicate(*i) ? result.first : result.second,
+        *i);
+  }
+  return result;
+}
+
+// partition_in_place/stable_partition_in_place
+// Reorders the container so that the matching elements come first and
+// returns the position of the first element that doesn't match. The unstable
+// version never allocates.
+template<typename Container, typename Predicate>
+typename Container::iterator partition_in_place(
+    Container& container,
+    Predicate predicate) {
+  UNDERSCORE_PROFILE("partition_in_place", container);
+  return std::partition(container.begin(), container.end(), predicate);
+}
+
+template<typename Container, typename Predicate>
+typename Container::iterator stable_partition_in_place(
+    Container& container,
+    Predicate predicate) {
+  UNDERSCORE_PROFILE("stable_partition_in_place", container);
+  return std::stable_partition(container.begin(), container.end(), predicate);
+}
+
+// compact
+namespace helper {
+struct IsFalsy {
+  template<typename Argument>
+  bool operator()(Argument const& argument) const {
+    return !static_cast<bool>(argument);
+  }
+};
+}  // namespace helper
+
+template<typename ResultContainer, typename Container>
+ResultContainer compact(Container const & container) {
+  UNDERSCORE_PROFILE("compact", container);
+  ResultContainer result;
+  for (typename Container::const_iterator i = container.begin();
+      i != container.end();
+      ++i) {
+    if (static_cast<bool>(*i)) {
+      helper::add_to_container(result, *i);
+    }
+  }
+  return result;
+}
+
+template<typename ResultContainer, typename Container, typename Allocator>
+ResultContainer compact(
+    Container const& container,
+    Allocator const& allocator) {
+  UNDERSCORE_PROFILE("compact", container);
+  return reject<ResultContainer>(container, helper::IsFalsy(), allocator);
+}
+
+// compact_in_place
+template<typename Container>
+void compact_in_place(Container& container) {
+  UNDERSCORE_PROFILE("compact_in_place", container);
+  helper::erase_if(container, helper::IsFalsy());
+}
+
+// flatten
+namespace helper {
+template<typename ResultContainer, typename Container>
+void flatten_one_layer(ResultContainer& result, Container const& container) {
+  for (typename Container::const_iterator i = container.begin();
+      i != container.end();
+      ++i) {
+    for(typename Container::value_type::const_iterator j = i->begin();
+        j != i->end();
+        ++j) {
+      add_to_container(result, *j);
+    }
+  }
+}
+
+// Elements that have a const_iterator are containers themselves, and are
+// flattened recursively.
+#if defined(UNDERSCORE_CONCEPTS)
+template<typename T>
+concept Nested = requires {
+  typename T::const_iterator;
+};
+
+template<typename ResultContainer, typename Container>
+void flatten_loop(ResultContainer& result, Container const& container) {
+  for (typename Container::const_iterator i = container.begin();
+      i != container.end();
+      ++i) {
+    if constexpr (Nested<typename Container::value_type>) {
+      flatten_loop(result, *i);
+    } else {
+      add_to_container(result, *i);
+    }
+  }
+}
+#else
+template<typename T>
+class HasConstIterator {
+ private:
+  typedef char yes[1];
+  typedef char no[2];
+  template<typename C>
+  static yes& test(typename C::const_iterator*);
+  template<typename C>
+  static no& test(...);
+ public:
+  static bool const value = sizeof(test<T>(0)) == sizeof(yes);
+};
+
+template<typename ResultContainer, typename Container>
+typename enable_if<
+    !HasConstIterator<typename Container::value_type>::value,
+    void>::type flatten_loop(
+    ResultContainer& result,
+    Container const& container) {
+  for (typename Container::const_iterator i = container.begin();
+      i != container.end();
+      ++i) {
+    add_to_container(result, *i);
+  }
+}
+
+template<typename ResultContainer, typename Container>
+typename enable_if<
+    HasConstIterator<typename Container::value_type>::value,
+    void>::type flatten_loop(
+    ResultContainer& result,
+    Container const& container) {
+  for (typename Container::const_iterator i = container.begin();
+      i != container.end();
+      ++i) {
+    flatten_loop(result, *i);
+  }
+}
+#endif
+
+}  // namespace helper
+
+template<typename ResultContainer, typename Container>
+ResultContainer flatten(Container const& container) {
+  UNDERSCORE_PROFILE("flatten", container);
+  ResultContainer result;
+  helper::flatten_loop(result, container);
+  return result;
+}
+
+template<typename ResultContainer, typename Container, typename Allocator>
+ResultContainer flatten(
+    Container const& container,
+    Allocator const& allocator) {
+  UNDERSCORE_PROFILE("flatten", container);
+  ResultContainer result(allocator);
+  helper::flatten_loop(result, container);
+  return result;
+}
+
+template<typename ResultContainer, bool shallow, typename Container>
+typename helper::enable_if<shallow == true, ResultContainer>::type flatten(
+    Container const& container) {
+  UNDERSCORE_PROFILE("flatten", container);
+  ResultContainer result;
+  helper::flatten_one_layer(result, container);
+  return result;
+}
+
+template<typename ResultContainer, bool shallow, typename Container>
+typename helper::enable_if<shallow == false, ResultContainer>::type flatten(
+    Container const& container) {
+  return flatten<ResultContainer>(container);
+}
+
+template<typename ResultContainer,
+    bool shallow,
+    typename Container,
+    typename Allocator>
+typename helper::enable_if<shallow == true, ResultContainer>::type flatten(
+    Container const& container,
+    Allocator const& allocator) {
+  UNDERSCORE_PROFILE("flatten", container);
+  ResultContainer result(allocator);
+  helper::flatten_one_layer(result, container);
+  return result;
+}
+
+template<typename ResultContainer,
+    bool shallow,
+    typename Container,
+    typename Allocator>
+typename helper::enable_if<shallow == false, ResultContainer>::type flatten(
+    Container const& container,
+    Allocator const& allocator) {
+  return flatten<ResultContainer>(container, allocator);
+}
+
+// without
+namespace helper {
+template<typename T>
+class EqualTo {
+ public:
+  EqualTo(T const& value) : value_(value) {
+  }
+
+  bool operator()(T const& other) const {
+    return other == value_;
+  }
+
+ private:
+  T const& value_;
+};
+}  // namespace helper
+
+template<typename ResultContainer, typename Container>
+ResultContainer without(
+    Container const& container,
+    typename Container::value_type const& value) {
+  UNDERSCORE_PROFILE("without", container);
+  return reject<ResultContainer>(
+      container,
+      helper::EqualTo<typename Container::value_type>(value));
+}
+
+template<typename ResultContainer, typename Container, typename Allocator>
+ResultContainer without(
+    Container const& container,
+    typename Container::value_type const& value,
+    Allocator const& allocator) {
+  UNDERSCORE_PROFILE("without", container);
+  return reject<ResultContainer>(
+      container,
+      helper::EqualTo<typename Container::value_type>(value),
+      allocator);
+}
+
+// without_in_place
+template<typename Container>
+void without_in_place(
+    Container& container,
+    typename Container::value_type const& value) {
+  UNDERSCORE_PROFILE("without_in_place", container);
+  helper::erase_if(
+      container,
+      helper::EqualTo<typename Container::value_type>(value));
+}
+
+// uniq/unique
+template<typename ResultContainer,
+    typename Key,
+    typename Container,
+    typename Function>
+ResultContainer uniq(
+    Container const& container,
+    bool is_sorted,
+    Function function) {
+  UNDERSCORE_PROFILE("uniq", container);
+  ResultContainer result;
+  std::vector<Key> keys = map<std::vector<Key> >(container, function);
+  if (container.size() < 3) {
+    is_sorted = true;
+  }
+
+  std::vector<Key> memo;
+  for (std::pair<
+      typename std::vector<Key>::const_iterator,
+      typename Container::const_iterator> i = std::make_pair(
+      keys.begin(),
+      container.begin());
+      i.first != keys.end();
+      ++i.first, ++i.second) {
+    if (is_sorted ?
+        !memo.size() || *last(memo) != *i.first :
+        !include(memo, *i.first)) {
+      helper::add_to_container(memo, *i.first);
+      helper::add_to_container(result, *i.second);
+    }
+  }
+  return result;
+}
+
+template<typename ResultContainer,
+    typename Key,
+    typename Container,
+    typename Function>
+ResultContainer uniq(Container const& container, Function function) {
+  return uniq<ResultContainer, Key>(container, false, function);
+}
+
+template<typename ResultContainer, typename Container>
+ResultContainer uniq(Container const& container, bool is_sorted) {
+  UNDERSCORE_PROFILE("uniq", container);
+  ResultContainer result;
+  if (container.size() < 3) {
+    is_sorted = true;
+  }
+
+  std::vector<typename Container::value_type> memo;
+  for (typename Container::const_iterator i = container.begin();
+      i != container.end();
+      ++i) {
+    if (is_sorted ?
+        !memo.size() || *last(memo) != *i :
+        !include(memo, *i)) {
+      helper::add_to_container(memo, *i);
+      helper::add_to_container(result, *i);
+    }
+  }
+  return result;
+}
+
+template<typename ResultContainer, typename Container>
+ResultContainer uniq(Container const& container) {
+  return uniq<ResultContainer>(container, false);
+}
+
+template<typename ResultContainer,
+    typename Key,
+    typename Container,
+    typename Function,
+    typename Allocator>
+ResultContainer uniq(
+    Container const& container,
+    bool is_sorted,
+    Function function,
+    Allocator const& allocator) {
+  UNDERSCORE_PROFILE("uniq", container);
+  ResultContainer result(allocator);
+  typename helper::ScratchVector<Key, Allocator>::type keys(allocator);
+  keys.reserve(container.size());
+  for (typename Container::const_iterator i = container.begin();
+      i != container.end();
+      ++i) {
+    keys.push_back(function(*i));
+  }
+  UNDERSCORE_COUNT_SCRATCH(keys);
+  if (container.size() < 3) {
+    is_sorted = true;
+  }
+
+  typename helper::ScratchVector<Key, Allocator>::type memo(allocator);
+  typename Container::const_iterator element = container.begin();
+  for (typename helper::ScratchVector<Key, Allocator>::type::const_iterator
+      i = keys.begin();
+      i != keys.end();
+      ++i, ++element) {
+    if (is_sorted ?
+        !memo.size() || memo.back() != *i :
+        !include(memo, *i)) {
+      helper::add_to_container(memo, *i);
+      helper::add_to_container(result, *element);
+    }
+  }
+  return result;
+}
+
+template<typename ResultContainer,
+    typename Key,
+    typename Container,
+    typename Function,
+    typename Allocator>
+ResultContainer uniq(
+    Container const& container,
+    Function function,
+    Allocator const& allocator) {
+  return uniq<ResultContainer, Key>(container, false, function, allocator);
+}
+
+template<typename ResultContainer, typename Container, typename Allocator>
+ResultContainer uniq(
+    Container const& container,
+    bool is_sorted,
+    Allocator const& allocator) {
+  return uniq<ResultContainer, typename Container::value_type>(
+      container,
+      is_sorted,
+      helper::Identity<typename Container::value_type>(),
+      allocator);
+}
+
+template<typename ResultContainer,
+    typename Key,
+    typename Container,
+    typename Function>
+ResultContainer unique(
+    Container const& container,
+    bool is_sorted,
+    Function function) {
+  return uniq<ResultContainer, Key>(container, is_sorted, function);
+}
+
+template<typename ResultContainer,
+    typename Key,
+    typename Container,
+    typename Function>
+ResultContainer unique(Container const& container, Function function) {
+  return uniq<ResultContainer, Key>(container, false, function);
+}
+
+template<typename ResultContainer, typename Container>
+ResultContainer unique(Container const& container, bool is_sorted) {
+  return uniq<ResultContainer>(container, is_sorted);
+}
+
+template<typename ResultContainer, typename Container>
+ResultContainer unique(Container const& container) {
+  return uniq<ResultContainer>(container, false);
+}
+
+template<typename ResultContainer,
+    typename Key,
+    typename Container,
+    typename Function,
+    typename Allocator>
+ResultContainer unique(
+    Container const& container,
+    bool is_sorted,
+    Function function,
+    Allocator const& allocator) {
+  return uniq<ResultContainer, Key>(container, is_sorted, function, allocator);
+}
+
+template<typename ResultContainer,
+    typename Key,
+    typename Container,
+    typename Function,
+    typename Allocator>
+ResultContainer unique(
+    Container const& container,
+    Function function,
+    Allocator const& allocator) {
+  return uniq<ResultContainer, Key>(container, false, function, allocator);
+}
+
+template<typename ResultContainer, typename Container, typename Allocator>
+ResultContainer unique(
+    Container const& container,
+    bool is_sorted,
+    Allocator const& allocator) {
+  return uniq<ResultContainer>(container, is_sorted, allocator);
+}
+
+// uniq_in_place/unique_in_place
+namespace helper {
+// Kept elements are swapped to the front of the sequence rather than copied,
+// so nothing is allocated even for element types that own memory. The
+// unsorted case searches the kept prefix, which is the same quadratic scan
+// that uniq performs over its memo.
+template<typename Container, typename Function>
+typename enable_if<
+  !IsAssociative<Container>::value,
+  void>::type remove_duplicates(
+    Container& container,
+    bool is_sorted,
+    Function function) {
+  typename Container::iterator kept = container.begin();
+  typename Container::iterator previous = container.end();
+  for (typename Container::iterator i = container.begin();
+      i != container.end();
+      ++i) {
+    bool is_new = true;
+    if (is_sorted) {
+      is_new = previous == container.end() ||
+          function(*previous) != function(*i);
+    } else {
+      for (typename Container::iterator j = container.begin();
+          j != kept;
+          ++j) {
+        if (function(*j) == function(*i)) {
+          is_new = false;
+          break;
+        }
+      }
+    }
+
+    if (is_new) {
+      if (kept != i) {
+        std::iter_swap(kept, i);
+      }
+      previous = kept++;
+    }
+  }
+  container.erase(kept, container.end());
+}
+
+template<typename Container, typename Function>
+typename enable_if<
+  IsAssociative<Container>::value,
+  void>::type remove_duplicates(
+    Container& container,
+    bool is_sorted,
+    Function function) {
+  typename Container::iterator previous = container.end();
+  for (typename Container::iterator i = container.begin();
+      i != container.end();) {
+    bool is_new = true;
+    if (is_sorted) {
+      is_new = previous == container.end() ||
+          function(*previous) != function(*i);
+    } else {
+      for (typename Container::iterator j = container.begin();
+          j != i;
+          ++j) {
+        if (function(*j) == function(*i)) {
+          is_new = false;
+          break;
+        }
+      }
+    }
+
+    if (is_new) {
+      previous = i++;
+    } else {
+      container.erase(i++);
+    }
+  }
+}
+}  // namespace helper
+
+// Unlike uniq, no key type is needed, since the keys are compared as they are
+// computed and never stored.
+template<typename Container, typename Function>
+void uniq_in_place(Container& container, bool is_sorted, Function function) {
+  UNDERSCORE_PROFILE("uniq_in_place", container);
+  if (container.size() < 3) {
+    is_sorted = true;
+  }
+  helper::remove_duplicates(container, is_sorted, function);
+}
+
+template<typename Container, typename Function>
+void uniq_in_place(Container& container, Function function) {
+  uniq_in_place(container, false, function);
+}
+
+template<typename Container>
+void uniq_in_place(Container& container, bool is_sorted) {
+  uniq_in_place(
+      container,
+      is_sorted,
+      helper::Identity<typename Container::value_type>());
+}
+
+template<typename Container>
+void uniq_in_place(Container& container) {
+  uniq_in_place(container, false);
+}
+
+template<typename Container, typename Function>
+void unique_in_place(Container& container, bool is_sorted, Function function) {
+  uniq_in_place(container, is_sorted, function);
+}
+
+template<typename Container, typename Function>
+void unique_in_place(Container& container, Function function) {
+  uniq_in_place(container, false, function);
+}
+
+template<typename Container>
+void unique_in_place(Container& container, bool is_sorted) {
+  uniq_in_place(container, is_sorted);
+}
+
+template<typename Container>
+void unique_in_place(Container& container) {
+  uniq_in_place(container, false);
+}
+
+// union_of
+template<typename ResultContainer, typename Container1, typename Container2>
+ResultContainer union_of(
+    Container1 const& container1,
+    Container2 const& container2) {
+  UNDERSCORE_PROFILE_PAIR("union_of", container1, container2);
+  std::vector<typename ResultContainer::value_type> left(
+    container1.begin(),
+    container1.end());
+  std::vector<typename ResultContainer::value_type> right(
+    container2.begin(),
+    container2.end());
+  std::sort(left.begin(), left.end());
+  std::sort(right.begin(), right.end());
+  UNDERSCORE_COUNT_SCRATCH(left);
+  UNDERSCORE_COUNT_SCRATCH(right);
+  
+  std::vector<typename ResultContainer::value_type> union_result;
+  union_result.reserve(left.size() + right.size());
+  std::set_union(
+      left.begin(),
+      left.end(),
+      right.begin(),
+      right.end(),
+      std::back_inserter(union_result));
+  UNDERSCORE_COUNT_SCRATCH(union_result);
+  ResultContainer result(union_result.begin(), union_result.end());
+  UNDERSCORE_COUNT_RESULT(result);
+  return result;
+}
+
+// intersection
+template<typename ResultContainer, typename Container1, typename Container2>
+ResultContainer intersection(
+    Container1 const& container1,
+    Container2 const& container2) {
+  UNDERSCORE_PROFILE_PAIR("intersection", container1, container2);
+  std::vector<typename ResultContainer::value_type> left(
+    container1.begin(),
+    container1.end());
+  std::vector<typename ResultContainer::value_type> right(
+    container2.begin(),
+    container2.end());
+  std::sort(left.begin(), left.end());
+  std::sort(right.begin(), right.end());
+  UNDERSCORE_COUNT_SCRATCH(left);
+  UNDERSCORE_COUNT_SCRATCH(right);
+  
+  std::vector<typename ResultContainer::value_type> union_result;
+  union_result.reserve(std::min(left.size(), right.size()));
+  std::set_intersection(
+      left.begin(),
+      left.end(),
+      right.begin(),
+      right.end(),
+      std::back_inserter(union_result));
+  UNDERSCORE_COUNT_SCRATCH(union_result);
+  ResultContainer result(union_result.begin(), union_result.end());
+  UNDERSCORE_COUNT_RESULT(result);
+  return result;
+}
+
+// difference
+template<typename ResultContainer, typename Container1, typename Container2>
+ResultContainer difference(
+    Container1 const& container1,
+    Container2 const& container2) {
+  UNDERSCORE_PROFILE_PAIR("difference", container1, container2);
+  std::vector<typename ResultContainer::value_type> left(
+    container1.begin(),
+    container1.end());
+  std::vector<typename ResultContainer::value_type> right(
+    container2.begin(),
+    container2.end());
+  std::sort(left.begin(), left.end());
+  std::sort(right.begin(), right.end());
+  UNDERSCORE_COUNT_SCRATCH(left);
+  UNDERSCORE_COUNT_SCRATCH(right);
+  
+  std::vector<typename ResultContainer::value_type> union_result;
+  union_result.reserve(left.size());
+  std::set_difference(
+      left.begin(),
+      left.end(),
+      right.begin(),
+      right.end(),
+      std::back_inserter(union_result));
+  UNDERSCORE_COUNT_SCRATCH(union_result);
+  ResultContainer result(union_result.begin(), union_result.end());
+  UNDERSCORE_COUNT_RESULT(result);
+  return result;
+}
+namespace helper {
+struct SetUnion {
+  template<typename Input1, typename Input2, typename Output>
+  Output operator()(
+      Input1 first1,
+      Input1 last1,
+      Input2 first2,
+      Input2 last2,
+      Output output) const {
+    return std::set_union(first1, last1, first2, last2, output);
+  }
+};
+
+struct SetIntersection {
+  template<typename Input1, typename Input2, typename Output>
+  Output operator()(
+      Input1 first1,
+      Input1 last1,
+      Input2 first2,
+      Input2 last2,
+      Output output) const {
+    return std::set_intersection(first1, last1, first2, last2, output);
+  }
+};
+
+struct SetDifference {
+  template<typename Input1, typename Input2, typename Output>
+  Output operator()(
+      Input1 first1,
+      Input1 last1,
+      Input2 first2,
+      Input2 last2,
+      Output output) const {
+    return std::set_difference(first1, last1, first2, last2, output);
+  }
+};
+
+template<typename ResultContainer,
+    typename Container1,
+    typename Container2,
+    typename Operation,
+    typename Allocator>
+ResultContainer sorted_set_operation(
+    Container1 const& container1,
+    Container2 const& container2,
+    Operation operation,
+    Allocator const& allocator) {
+  typedef typename ScratchVector<
+      typename ResultContainer::value_type,
+      Allocator>::type Scratch;
+  Scratch left(container1.begin(), container1.end(), allocator);
+  Scratch right(container2.begin(), container2.end(), allocator);
+  UNDERSCORE_COUNT_SCRATCH(left);
+  UNDERSCORE_COUNT_SCRATCH(right);
+  std::sort(left.begin(), left.end());
+  std::sort(right.begin(), right.end());
+
+  Scratch combined(allocator);
+  combined.reserve(left.size() + right.size());
+  operation(
+      left.begin(),
+      left.end(),
+      right.begin(),
+      right.end(),
+      std::back_inserter(combined));
+  UNDERSCORE_COUNT_SCRATCH(combined);
+  ResultContainer result(allocator);
+  append_range(result, combined.begin(), combined.end());
+  return result;
+}
+}  // namespace helper
+
+template<typename ResultContainer,
+    typename Container1,
+    typename Container2,
+    typename Allocator>
+ResultContainer union_of(
+    Container1 const& container1,
+    Container2 const& container2,
+    Allocator const& allocator) {
+  UNDERSCORE_PROFILE_PAIR("union_of", container1, container2);
+  return helper::sorted_set_operation<ResultContainer>(
+      container1,
+      container2,
+      helper::SetUnion(),
+      allocator);
+}
+
+template<typename ResultContainer,
+    typename Container1,
+    typename Container2,
+    typename Allocator>
+ResultContainer intersection(
+    Container1 const& container1,
+    Container2 const& container2,
+    Allocator const& allocator) {
+  UNDERSCORE_PROFILE_PAIR("intersection", container1, container2);
+  return helper::sorted_set_operation<ResultContainer>(
+      container1,
+      container2,
+      helper::SetIntersection(),
+      allocator);
+}
+
+template<typename ResultContainer,
+    typename Container1,
+    typename Container2,
+    typename Allocator>
+ResultContainer difference(
+    Container1 const& container1,
+    Container2 const& container2,
+    Allocator const& allocator) {
+  UNDERSCORE_PROFILE_PAIR("difference", container1, container2);
+  return helper::sorted_set_operation<ResultContainer>(
+      container1,
+      container2,
+      helper::SetDifference(),
+      allocator);
+}
+
+// sort_merge_join
+// Correlates two containers on a key computed from each side. Both sides are
+// sorted by key (as pointers, so the elements themselves are never copied)
+// and merged; the sink is called as `sink(left_element, right_element)` for
+// every pair with equal keys, in key order. This only needs the keys to be
+// ordered with `<`.
+namespace helper {
+template<typename Key, typename Element>
+struct KeyedPointer {
+  Key key;
+  Element const* element;
+
+  bool operator<(KeyedPointer const& other) const {
+    return key < other.key;
+  }
+};
+
+template<typename Key,
+    typename Container,
+    typename Function,
+    typename Allocator>
+typename ScratchVector<
+    KeyedPointer<Key, typename Container::value_type>,
+    Allocator>::type sorted_by_key(
+    Container const& container,
+    Function function,
+    Allocator const& allocator) {
+  typename ScratchVector<
+      KeyedPointer<Key, typename Container::value_type>,
+      Allocator>::type keyed(allocator);
+  keyed.reserve(container.size());
+  for (typename Container::const_iterator i = container.begin();
+      i != container.end();
+      ++i) {
+    KeyedPointer<Key, typename Container::value_type> pointer = {
+      function(*i),
+      &*i
+    };
+    keyed.push_back(pointer);
+  }
+  std::stable_sort(keyed.begin(), keyed.end());
+  UNDERSCORE_COUNT_SCRATCH(keyed);
+  return keyed;
+}
+}  // namespace helper
+
+template<typename Key,
+    typename Left,
+    typename Right,
+    typename LeftKey,
+    typename RightKey,
+    typename Sink,
+    typename Allocator>
+void sort_merge_join(
+    Left const& left,
+    Right const& right,
+    LeftKey left_key,
+    RightKey right_key,
+    Sink sink,
+    Allocator const& allocator) {
+  UNDERSCORE_PROFILE_PAIR("sort_merge_join", left, right);
+  typedef typename helper::ScratchVector<
+      helper::KeyedPointer<Key, typename Left::value_type>,
+      Allocator>::type LeftKeys;
+  typedef typename helper::ScratchVector<
+      helper::KeyedPointer<Key, typename Right::value_type>,
+      Allocator>::type RightKeys;
+  LeftKeys const left_keys =
+      helper::sorted_by_key<Key>(left, left_key, allocator);
+  RightKeys const right_keys =
+      helper::sorted_by_key<Key>(right, right_key, allocator);
+
+  typename LeftKeys::const_iterator l = left_keys.begin();
+  typename RightKeys::const_iterator r = right_keys.begin();
+  while (l != left_keys.end() && r != right_keys.end()) {
+    if (l->key < r->key) {
+      ++l;
+    } else if (r->key < l->key) {
+      ++r;
+    } else {
+      typename RightKeys::const_iterator run_end = r;
+      while (run_end != right_keys.end() && !(l->key < run_end->key)) {
+        ++run_end;
+      }
+      Key const key = l->key;
+      for (; l != left_keys.end() && !(key < l->key); ++l) {
+        for (typename RightKeys::const_iterator i = r; i != run_end; ++i) {
+          sink(*l->element, *i->element);
+        }
+      }
+      r = run_end;
+    }
+  }
+}
+
+template<typename Key,
+    typename Left,
+    typename Right,
+    typename LeftKey,
+    typename RightKey,
+    typename Sink>
+void sort_merge_join(
+    Left const& left,
+    Right const& right,
+    LeftKey left_key,
+    RightKey right_key,
+    Sink sink) {
+  sort_merge_join<Key>(
+      left,
+      right,
+      left_key,
+      right_key,
+      sink,
+      std::allocator<char>());
+}
+
+#if __cplusplus >= 201103L
+// join/left_join/semi_join/anti_join
+// Hash joins between two containers on keys computed by a projection of each
+// side. The keys need std::hash and ==. An open addressing table is built
+// over one side, holding each element's key and a pointer to it, and the
+// other side is streamed through it, so the cost is O(n + m) instead of the
+// O(n * m) of filtering one container by `include` on the other.
+namespace helper {
+inline std::size_t mix_hash(std::size_t hash) {
+  unsigned long long mixed = hash;
+  mixed ^= mixed >> 33;
+  mixed *= 0xff51afd7ed558ccdULL;
+  mixed ^= mixed >> 33;
+  mixed *= 0xc4ceb9fe1a85ec53ULL;
+  mixed ^= mixed >> 33;
+  return static_cast<std::size_t>(mixed);
+}
+
+// Every distinct key owns one slot. Elements sharing a key are chained
+// through the entries in insertion order, so matches come out in the order
+// of the build side. The slots and entries are allocated with a rebound copy
+// of the allocator.
+template<typename Key,
+    typename Element,
+    typename Allocator = std::allocator<char> >
+class JoinTable {
+ public:
+  template<typename Container, typename Function>
+  JoinTable(
+      Container const& container,
+      Function function,
+      Allocator const& allocator = Allocator())
+      : slots_(allocator), entries_(allocator) {
+    std::size_t capacity = 16;
+    while (capacity < container.size() * 2) {
+      capacity *= 2;
+    }
+    slots_.assign(capacity, kEmpty);
+    entries_.reserve(container.size());
+    for (typename Container::const_iterator i = container.begin();
+        i != container.end();
+        ++i) {
+      insert(function(*i), &*i);
+    }
+    UNDERSCORE_COUNT_SCRATCH(slots_);
+    UNDERSCORE_COUNT_SCRATCH(entries_);
+  }
+
+  // Calls visitor(element) for every element with the key and returns
+  // whether there were any.
+  template<typename Visitor>
+  bool probe(Key const& key, Visitor visitor) const {
+    std::size_t const head = slots_[find_slot(key)];
+    if (head == kEmpty) {
+      return false;
+    }
+    for (std::size_t entry = head; entry != kEmpty;) {
+      visitor(*entries_[entry].element);
+      entry = entries_[entry].next;
+    }
+    return true;
+  }
+
+  bool contains(Key const& key) const {
+    return slots_[find_slot(key)] != kEmpty;
+  }
+
+ private:
+  static std::size_t const kEmpty = static_cast<std::size_t>(-1);
+
+  struct Entry {
+    Key key;
+    Element const* element;
+    std::size_t next;
+    std::size_t last;
+  };
+
+  // Linear probing: the slot holding the key, or the empty slot where it
+  // belongs.
+  std::size_t find_slot(Key const& key) const {
+    std::size_t const mask = slots_.size() - 1;
+    std::size_t slot = mix_hash(std::hash<Key>()(key)) & mask;
+    while (slots_[slot] != kEmpty && !(entries_[slots_[slot]].key == key)) {
+      slot = (slot + 1) & mask;
+    }
+    return slot;
+  }
+
+  void insert(Key const& key, Element const* element) {
+    std::size_t const slot = find_slot(key);
+    std::size_t const entry = entries_.size();
+    Entry const inserted = {key, element, kEmpty, entry};
+    entries_.push_back(inserted);
+    if (slots_[slot] == kEmpty) {
+      slots_[slot] = entry;
+    } else {
+      Entry& head = entries_[slots_[slot]];
+      entries_[head.last].next = entry;
+      head.last = entry;
+    }
+  }
+
+  typename ScratchVector<std::size_t, Allocator>::type slots_;
+  typename ScratchVector<Entry, Allocator>::type entries_;
+};
+
+template<typename Key, typename Element, typename Allocator>
+std::size_t const JoinTable<Key, Element, Allocator>::kEmpty;
+
+// Adds the elements of left that have (matched) or have no match in the
+// table, for semi_join and anti_join.
+template<typename ResultContainer,
+    typename Left,
+    typename LeftKey,
+    typename Table>
+void append_matches(
+    ResultContainer& result,
+    Left const& left,
+    LeftKey left_key,
+    Table const& table,
+    bool matched) {
+  for (typename Left::const_iterator l = left.begin(); l != left.end(); ++l) {
+    if (table.contains(left_key(*l)) == matched) {
+      add_to_container(result, *l);
+    }
+  }
+}
+}  // namespace helper
+
+// join
+// Calls `sink(left_element, right_element)` for every pair with equal keys.
+// The table is built over the smaller container and the larger one is probed
+// against it.
+template<typename Key,
+    typename Left,
+    typename Right,
+    typename LeftKey,
+    typename RightKey,
+    typename Sink,
+    typename Allocator>
+void join(
+    Left const& left,
+    Right const& right,
+    LeftKey left_key,
+    RightKey right_key,
+    Sink sink,
+    Allocator const& allocator) {
+  UNDERSCORE_PROFILE_PAIR("join", left, right);
+  typedef typename Left::value_type LeftValue;
+  typedef typename Right::value_type RightValue;
+  if (left.size() <= right.size()) {
+    helper::JoinTable<Key, LeftValue, Allocator> const table(
+        left,
+        left_key,
+        allocator);
+    for (typename Right::const_iterator r = right.begin();
+        r != right.end();
+        ++r) {
+      table.probe(right_key(*r), [&](LeftValue const& l) {
+        sink(l, *r);
+      });
+    }
+  } else {
+    helper::JoinTable<Key, RightValue, Allocator> const table(
+        right,
+        right_key,
+        allocator);
+    for (typename Left::const_iterator l = left.begin();
+        l != left.end();
+        ++l) {
+      table.probe(left_key(*l), [&](RightValue const& r) {
+        sink(*l, r);
+      });
+    }
+  }
+}
+
+template<typename Key,
+    typename Left,
+    typename Right,
+    typename LeftKey,
+    typename RightKey,
+    typename Sink>
+void join(
+    Left const& left,
+    Right const& right,
+    LeftKey left_key,
+    RightKey right_key,
+    Sink sink) {
+  join<Key>(left, right, left_key, right_key, sink, std::allocator<char>());
+}
+
+// left_join
+// Calls `sink(left_element, right_pointer)` for every pair with equal keys,
+// and once with a null right_pointer for each left element without a match.
+template<typename Key,
+    typename Left,
+    typename Right,
+    typename LeftKey,
+    typename RightKey,
+    typename Sink,
+    typename Allocator>
+void left_join(
+    Left const& left,
+    Right const& right,
+    LeftKey left_key,
+    RightKey right_key,
+    Sink sink,
+    Allocator const& allocator) {
+  UNDERSCORE_PROFILE_PAIR("left_join", left, right);
+  typedef typename Right::value_type RightValue;
+  helper::JoinTable<Key, RightValue, Allocator> const table(
+      right,
+      right_key,
+      allocator);
+  for (typename Left::const_iterator l = left.begin(); l != left.end(); ++l) {
+    bool const matched = table.probe(left_key(*l), [&](RightValue const& r) {
+      sink(*l, &r);
+    });
+    if (!matched) {
+      sink(*l, static_cast<RightValue const*>(nullptr));
+    }
+  }
+}
+
+template<typename Key,
+    typename Left,
+    typename Right,
+    typename LeftKey,
+    typename RightKey,
+    typename Sink>
+void left_join(
+    Left const& left,
+    Right const& right,
+    LeftKey left_key,
+    RightKey right_key,
+    Sink sink) {
+  left_join<Key>(
+      left,
+      right,
+      left_key,
+      right_key,
+      sink,
+      std::allocator<char>());
+}
+
+// semi_join
+// The elements of left that have at least one match in right.
+template<typename ResultContainer,
+    typename Key,
+    typename Left,
+    typename Right,
+    typename LeftKey,
+    typename RightKey>
+ResultContainer semi_join(
+    Left const& left,
+    Right const& right,
+    LeftKey left_key,
+    RightKey right_key) {
+  UNDERSCORE_PROFILE_PAIR("semi_join", left, right);
+  helper::JoinTable<Key, typename Right::value_type> const table(
+      right,
+      right_key);
+  ResultContainer result;
+  helper::append_matches(result, left, left_key, table, true);
+  return result;
+}
+
+template<typename ResultContainer,
+    typename Key,
+    typename Left,
+    typename Right,
+    typename LeftKey,
+    typename RightKey,
+    typename Allocator>
+ResultContainer semi_join(
+    Left const& left,
+    Right const& right,
+    LeftKey left_key,
+    RightKey right_key,
+    Allocator const& allocator) {
+  UNDERSCORE_PROFILE_PAIR("semi_join", left, right);
+  helper::JoinTable<Key, typename Right::value_type, Allocator> const table(
+      right,
+      right_key,
+      allocator);
+  ResultContainer result(allocator);
+  helper::append_matches(result, left, left_key, table, true);
+  return result;
+}
+
+// anti_join
+// The elements of left that have no match in right.
+template<typename ResultContainer,
+    typename Key,
+    typename Left,
+    typename Right,
+    typename LeftKey,
+    typename RightKey>
+ResultContainer anti_join(
+    Left const& left,
+    Right const& right,
+    LeftKey left_key,
+    RightKey right_key) {
+  UNDERSCORE_PROFILE_PAIR("anti_join", left, right);
+  helper::JoinTable<Key, typename Right::value_type> const table(
+      right,
+      right_key);
+  ResultContainer result;
+  helper::append_matches(result, left, left_key, table, false);
+  return result;
+}
+
+template<typename ResultContainer,
+    typename Key,
+    typename Left,
+    typename Right,
+    typename LeftKey,
+    typename RightKey,
+    typename Allocator>
+ResultContainer anti_join(
+    Left const& left,
+    Right const& right,
+    LeftKey left_key,
+    RightKey right_key,
+    Allocator const& allocator) {
+  UNDERSCORE_PROFILE_PAIR("anti_join", left, right);
+  helper::JoinTable<Key, typename Right::value_type, Allocator> const table(
+      right,
+      right_key,
+      allocator);
+  ResultContainer result(allocator);
+  helper::append_matches(result, left, left_key, table, false);
+  return result;
+}
+#endif
+
+// zip
+template<typename ResultContainer, typename Container1, typename Container2>
+ResultContainer zip(
+    const Container1& container1,
+    const Container2& container2) {
+  UNDERSCORE_PROFILE_PAIR("zip", container1, container2);
+  ResultContainer result;
+  typename Container1::const_iterator left = container1.begin();
+  typename Container2::const_iterator right = container2.begin();
+  while (left != container1.end() && right != container2.end()) {
+    helper::add_to_container(
+        result,
+        typename ResultContainer::value_type(*left++, *right++));
+  }
+  return result;
+}
+
+template<typename ResultContainer,
+    typename Container1,
+    typename Container2,
+    typename Allocator>
+ResultContainer zip(
+    const Container1& container1,
+    const Container2& container2,
+    Allocator const& allocator) {
+  UNDERSCORE_PROFILE_PAIR("zip", container1, container2);
+  ResultContainer result(allocator);
+  typename Container1::const_iterator left = container1.begin();
+  typename Container2::const_iterator right = container2.begin();
+  while (left != container1.end() && right != container2.end()) {
+    helper::add_to_container(
+        result,
+        typename ResultContainer::value_type(*left++, *right++));
+  }
+  return result;
+}
+
+// index_of
+template<typename Container>
+int index_of(Container& container, typename Container::value_type value) {
+  UNDERSCORE_PROFILE("index_of", container);
+  typename Container::iterator value_position = std::find(
+      container.begin(),
+      container.end(),
+      value);
+  return value_position == container.end() ?
+      -1 :
+      std::distance(container.begin(), value_position);
+}
+
+template<typename Container>
+int index_of(Container& container, typename Container::value_type value, bool is_sorted) {
+  UNDERSCORE_PROFILE("index_of", container);
+  if (!is_sorted) {
+    return index_of(container, value);
+  }
+  typename Container::iterator value_lower_bound = std::lower_bound(
+      container.begin(),
+      container.end(),
+      value);
+  return value_lower_bound == container.end() || *value_lower_bound != value ?
+      -1 :
+      std::distance(container.begin(), value_lower_bound);
+}
+
+// last_index_of
+template<typename Container>
+int last_index_of(
+    Container const& container,
+    typename Container::value_type value) {
+  UNDERSCORE_PROFILE("last_index_of", container);
+  typename Container::const_iterator result = std::find(
+      container.begin(),
+      container.end(),
+      value);
+  typename Container::const_iterator i = result;
+  while (i != container.end()) {
+    i = std::find(++i, container.end(), value);
+    if (i != container.end()) {
+      result = i;
+    }
+  }
+  return result == container.end() ?
+      -1 :
+      std::distance(container.begin(), result);
+}
+
+// range
+template<typename ResultContainer>
+ResultContainer range(int start, int stop, int step) {
+  int length = std::max((stop - start) / step, 0);
+  UNDERSCORE_PROFILE_COUNT("range", length);
+  int index = 0;
+  ResultContainer result;
+
+  while (index < length) {
+    helper::add_to_container(result, start);
+    start += step;
+    ++index;
+  }
+
+  return result;
+}
+
+template<typename ResultContainer, typename Allocator>
+ResultContainer range(
+    int start,
+    int stop,
+    int step,
+    Allocator const& allocator) {
+  int length = std::max((stop - start) / step, 0);
+  UNDERSCORE_PROFILE_COUNT("range", length);
+  int index = 0;
+  ResultContainer result(allocator);
+
+  while (index < length) {
+    helper::add_to_container(result, start);
+    start += step;
+    ++index;
+  }
+
+  return result;
+}
+
+template<typename ResultContainer>
+ResultContainer range(int start, int stop) {
+  return range<ResultContainer>(start, stop, 1);
+}
+
+template<typename ResultContainer>
+ResultContainer range(int stop) {
+  return range<ResultContainer>(0, stop, 1);
+}
+
+}  // namespace underscore
+
+#endif  // UNDERSCORE_ARRAYS_H_
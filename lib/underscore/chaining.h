@@ -0,0 +1,63 @@
+#ifndef UNDERSCORE_CHAINING_H_
+#define UNDERSCORE_CHAINING_H_
+
+// Chaining: chain wraps a container so that calls can be strung together,
+// and value unwraps it again.
+
+#include "collections.h"
+
+namespace underscore {
+
+template<typename Container>
+class Wrapper;
+
+// chain
+template<typename Container>
+Wrapper<Container> chain(Container container) {
+  return Wrapper<Container>(container);
+}
+
+// value
+template<typename Container>
+typename Container::value_type value(Wrapper<Container>& wrapper) {
+  return wrapper.value();
+}
+
+template<typename Container>
+class Wrapper
+{
+ public:
+  typedef Container value_type;
+  Wrapper(Container container) : container_(container) {
+  }
+
+  Container value() {
+    return container_;
+  }
+
+  template<typename Function>
+  Wrapper& each(Function function) {
+    UNDERSCORE_PROFILE_STAGE("chain.each", container_);
+    underscore::each(container_, function);
+    return *this;
+  }
+
+  template<typename ResultContainer, typename Function>
+  Wrapper<ResultContainer> map(Function function) {
+    UNDERSCORE_PROFILE_STAGE("chain.map", container_);
+    return chain(
+        underscore::map<ResultContainer>(container_, function));
+  }
+
+  template<typename Function, typename Memo>
+  Wrapper<Memo> reduce(Function function, Memo memo) {
+    UNDERSCORE_PROFILE_STAGE("chain.reduce", container_);
+    return chain(underscore::reduce(container_, function, memo));
+  }
+ private:
+  Container container_;
+};
+
+}  // namespace underscore
+
+#endif  // UNDERSCORE_CHAINING_H_
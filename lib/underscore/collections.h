@@ -0,0 +1,1457 @@
+#ifndef UNDERSCORE_COLLECTIONS_H_
+#define UNDERSCORE_COLLECTIONS_H_
+
+// Collections: the functions that apply to any container, from each and map
+// to sort_by and group_by.
+
+#include <cstdlib>
+#include <map>
+#include <typeinfo>
+
+#if __cplusplus >= 201103L
+#include <atomic>
+#include <exception>
+#endif
+
+#include "helper.h"
+
+#if __cplusplus >= 201103L
+#include "parallel.h"
+#endif
+
+namespace underscore {
+
+// each/for_each
+template<typename Container, typename Function>
+void each(Container container, Function function) {
+  UNDERSCORE_PROFILE("each", container);
+  std::for_each(container.begin(), container.end(), function);
+}
+
+template<typename Container, typename Function>
+void for_each(Container container, Function function) {
+  each(container, function);
+}
+
+// map/collect
+template<typename ResultContainer, typename Container, typename Function>
+ResultContainer map(Container const& container, Function function) {
+  UNDERSCORE_PROFILE("map", container);
+  ResultContainer result;
+  for (typename Container::const_iterator i = container.begin();
+      i != container.end();
+      ++i) {
+    helper::add_to_container(result, function(*i));
+  }
+  return result;
+}
+
+template<typename ResultContainer, typename Container, typename Function>
+ResultContainer collect(Container const& container, Function function) {
+  return map<ResultContainer>(container, function);
+}
+
+template<typename ResultContainer,
+    typename Container,
+    typename Function,
+    typename Allocator>
+ResultContainer map(
+    Container const& container,
+    Function function,
+    Allocator const& allocator) {
+  UNDERSCORE_PROFILE("map", container);
+  ResultContainer result(allocator);
+  for (typename Container::const_iterator i = container.begin();
+      i != container.end();
+      ++i) {
+    helper::add_to_container(result, function(*i));
+  }
+  return result;
+}
+
+template<typename ResultContainer,
+    typename Container,
+    typename Function,
+    typename Allocator>
+ResultContainer collect(
+    Container const& container,
+    Function function,
+    Allocator const& allocator) {
+  return map<ResultContainer>(container, function, allocator);
+}
+
+// reduce/inject/foldl
+template<typename Container, typename Function, typename Memo>
+Memo reduce(Container const& container, Function function, Memo memo) {
+  UNDERSCORE_PROFILE("reduce", container);
+  for (typename Container::const_iterator i = container.begin();
+      i != container.end();
+      ++i) {
+    memo = function(memo, *i);
+  }
+  return memo;
+}
+
+template<typename Container, typename Function, typename Memo>
+Memo inject(Container const& container, Function function, Memo memo) {
+  return reduce(container, function, memo);
+}
+
+template<typename Container, typename Function, typename Memo>
+Memo foldl(Container const& container, Function function, Memo memo) {
+  return reduce(container, function, memo);
+}
+
+// reduce_right/foldr
+template<typename Container, typename Function, typename Memo>
+Memo reduce_right(Container const& container, 
+    Function function, 
+    Memo memo) {
+  UNDERSCORE_PROFILE("reduce_right", container);
+  for (typename Container::const_reverse_iterator i = container.rbegin();
+      i != container.rend();
+      ++i) {
+    memo = function(memo, *i);
+  }
+  return memo;
+}
+
+template<typename Container, typename Function, typename Memo>
+Memo foldr(Container const& container, 
+    Function function, 
+    Memo memo) {
+  return reduce_right(container, function, memo);
+}
+
+// scan/inclusive_scan
+// The running results of reduce: each output element is the memo after the
+// corresponding input element has been folded in. The optional projection is
+// applied to each element before it is passed to the function. The overloads
+// taking an allocator also take the projection, so that it can't be mistaken
+// for one.
+namespace helper {
+// Adds the memo after (or, for exclusive scans, before) each element is
+// folded in.
+template<typename ResultContainer,
+    typename Container,
+    typename Function,
+    typename Memo,
+    typename Projection>
+void scan_into(
+    ResultContainer& result,
+    Container const& container,
+    Function function,
+    Memo memo,
+    Projection projection,
+    bool exclusive) {
+  for (typename Container::const_iterator i = container.begin();
+      i != container.end();
+      ++i) {
+    if (exclusive) {
+      add_to_container(result, memo);
+    }
+    memo = function(memo, projection(*i));
+    if (!exclusive) {
+      add_to_container(result, memo);
+    }
+  }
+}
+}  // namespace helper
+
+template<typename Container,
+    typename OutputIterator,
+    typename Function,
+    typename Memo,
+    typename Projection>
+OutputIterator scan_to(
+    Container const& container,
+    OutputIterator output,
+    Function function,
+    Memo memo,
+    Projection projection) {
+  UNDERSCORE_PROFILE("scan_to", container);
+  for (typename Container::const_iterator i = container.begin();
+      i != container.end();
+      ++i) {
+    memo = function(memo, projection(*i));
+    *output++ = memo;
+  }
+  return output;
+}
+
+template<typename Container,
+    typename OutputIterator,
+    typename Function,
+    typename Memo>
+OutputIterator scan_to(
+    Container const& container,
+    OutputIterator output,
+    Function function,
+    Memo memo) {
+  return scan_to(
+      container,
+      output,
+      function,
+      memo,
+      helper::Identity<typename Container::value_type>());
+}
+
+template<typename ResultContainer,
+    typename Container,
+    typename Function,
+    typename Memo,
+    typename Projection>
+ResultContainer scan(
+    Container const& container,
+    Function function,
+    Memo memo,
+    Projection projection) {
+  UNDERSCORE_PROFILE("scan", container);
+  ResultContainer result;
+  helper::scan_into(result, container, function, memo, projection, false);
+  return result;
+}
+
+template<typename ResultContainer,
+    typename Container,
+    typename Function,
+    typename Memo,
+    typename Projection,
+    typename Allocator>
+ResultContainer scan(
+    Container const& container,
+    Function function,
+    Memo memo,
+    Projection projection,
+    Allocator const& allocator) {
+  UNDERSCORE_PROFILE("scan", container);
+  ResultContainer result(allocator);
+  helper::scan_into(result, container, function, memo, projection, false);
+  return result;
+}
+
+template<typename ResultContainer,
+    typename Container,
+    typename Function,
+    typename Memo>
+ResultContainer scan(Container const& container, Function function, Memo memo) {
+  return scan<ResultContainer>(
+      container,
+      function,
+      memo,
+      helper::Identity<typename Container::value_type>());
+}
+
+template<typename ResultContainer,
+    typename Container,
+    typename Function,
+    typename Memo,
+    typename Projection>
+ResultContainer inclusive_scan(
+    Container const& container,
+    Function function,
+    Memo memo,
+    Projection projection) {
+  return scan<ResultContainer>(container, function, memo, projection);
+}
+
+template<typename ResultContainer,
+    typename Container,
+    typename Function,
+    typename Memo>
+ResultContainer inclusive_scan(
+    Container const& container,
+    Function function,
+    Memo memo) {
+  return scan<ResultContainer>(container, function, memo);
+}
+
+template<typename ResultContainer,
+    typename Container,
+    typename Function,
+    typename Memo,
+    typename Projection,
+    typename Allocator>
+ResultContainer inclusive_scan(
+    Container const& container,
+    Function function,
+    Memo memo,
+    Projection projection,
+    Allocator const& allocator) {
+  return scan<ResultContainer>(
+      container,
+      function,
+      memo,
+      projection,
+      allocator);
+}
+
+// exclusive_scan
+// Like scan, but each output element is the memo before the corresponding
+// input element is folded in, so the first output is the initial memo. This
+// is the usual way to turn bucket sizes into bucket offsets.
+template<typename Container,
+    typename OutputIterator,
+    typename Function,
+    typename Memo,
+    typename Projection>
+OutputIterator exclusive_scan_to(
+    Container const& container,
+    OutputIterator output,
+    Function function,
+    Memo memo,
+    Projection projection) {
+  UNDERSCORE_PROFILE("exclusive_scan_to", container);
+  for (typename Container::const_iterator i = container.begin();
+      i != container.end();
+      ++i) {
+    *output++ = memo;
+    memo = function(memo, projection(*i));
+  }
+  return output;
+}
+
+template<typename Container,
+    typename OutputIterator,
+    typename Function,
+    typename Memo>
+OutputIterator exclusive_scan_to(
+    Container const& container,
+    OutputIterator output,
+    Function function,
+    Memo memo) {
+  return exclusive_scan_to(
+      container,
+      output,
+      function,
+      memo,
+      helper::Identity<typename Container::value_type>());
+}
+
+template<typename ResultContainer,
+    typename Container,
+    typename Function,
+    typename Memo,
+    typename Projection>
+ResultContainer exclusive_scan(
+    Container const& container,
+    Function function,
+    Memo memo,
+    Projection projection) {
+  UNDERSCORE_PROFILE("exclusive_scan", container);
+  ResultContainer result;
+  helper::scan_into(result, container, function, memo, projection, true);
+  return result;
+}
+
+template<typename ResultContainer,
+    typename Container,
+    typename Function,
+    typename Memo,
+    typename Projection,
+    typename Allocator>
+ResultContainer exclusive_scan(
+    Container const& container,
+    Function function,
+    Memo memo,
+    Projection projection,
+    Allocator const& allocator) {
+  UNDERSCORE_PROFILE("exclusive_scan", container);
+  ResultContainer result(allocator);
+  helper::scan_into(result, container, function, memo, projection, true);
+  return result;
+}
+
+template<typename ResultContainer,
+    typename Container,
+    typename Function,
+    typename Memo>
+ResultContainer exclusive_scan(
+    Container const& container,
+    Function function,
+    Memo memo) {
+  return exclusive_scan<ResultContainer>(
+      container,
+      function,
+      memo,
+      helper::Identity<typename Container::value_type>());
+}
+
+// scan_in_place/exclusive_scan_in_place
+template<typename Container, typename Function>
+void scan_in_place(Container& container, Function function) {
+  UNDERSCORE_PROFILE("scan_in_place", container);
+  typename Container::iterator i = container.begin();
+  if (i == container.end()) {
+    return;
+  }
+  typename Container::iterator previous = i;
+  for (++i; i != container.end(); previous = i++) {
+    *i = function(*previous, *i);
+  }
+}
+
+template<typename Container, typename Function, typename Memo>
+void exclusive_scan_in_place(
+    Container& container,
+    Function function,
+    Memo memo) {
+  UNDERSCORE_PROFILE("exclusive_scan_in_place", container);
+  for (typename Container::iterator i = container.begin();
+      i != container.end();
+      ++i) {
+    Memo const next = function(memo, *i);
+    *i = memo;
+    memo = next;
+  }
+}
+
+#if __cplusplus >= 201103L
+// scan_in_place_parallel/exclusive_scan_in_place_parallel
+// A two pass reduce-then-scan over random access containers: every worker
+// reduces its own chunk, the chunk totals are combined into per-chunk
+// offsets, and then every worker scans its chunk starting from its offset.
+// The function must be associative. Inputs too small to be worth splitting
+// are scanned sequentially. Passing 0 workers uses the hardware concurrency.
+namespace helper {
+std::size_t const kMinimumParallelScanChunk = 1 << 14;
+
+template<typename Container, typename Function, typename Memo>
+void parallel_scan(
+    Container& container,
+    Function function,
+    Memo memo,
+    bool has_memo,
+    bool is_exclusive,
+    unsigned workers) {
+  typedef typename Container::value_type Value;
+  typename Container::iterator const first = container.begin();
+  std::size_t const count = container.size();
+  if (workers == 0) {
+    workers = default_workers();
+  }
+  std::size_t chunks = std::min<std::size_t>(
+      workers,
+      count / kMinimumParallelScanChunk);
+  if (chunks < 2) {
+    chunks = 1;
+  }
+  std::size_t const chunk_size = (count + chunks - 1) / chunks;
+
+  std::vector<Value> totals(chunks);
+  if (chunks > 1) {
+    parallel_for(chunks - 1, workers, [&](std::size_t begin, std::size_t end) {
+      for (std::size_t chunk = begin; chunk != end; ++chunk) {
+        std::size_t const chunk_begin = chunk * chunk_size;
+        std::size_t const chunk_end = std::min(chunk_begin + chunk_size, count);
+        Value total = first[chunk_begin];
+        for (std::size_t i = chunk_begin + 1; i != chunk_end; ++i) {
+          total = function(total, first[i]);
+        }
+        totals[chunk] = total;
+      }
+    });
+  }
+
+  // Each chunk after the first starts from the combined totals of all the
+  // chunks before it; the first starts from the memo, if there is one.
+  std::vector<Memo> offsets(chunks, memo);
+  for (std::size_t chunk = 1; chunk < chunks; ++chunk) {
+    offsets[chunk] = chunk == 1 && !has_memo ?
+        Memo(totals[0]) :
+        function(offsets[chunk - 1], totals[chunk - 1]);
+  }
+
+  parallel_for(chunks, workers, [&](std::size_t begin, std::size_t end) {
+    for (std::size_t chunk = begin; chunk != end; ++chunk) {
+      std::size_t const chunk_begin = chunk * chunk_size;
+      std::size_t const chunk_end = std::min(chunk_begin + chunk_size, count);
+      bool seeded = chunk > 0 || has_memo;
+      Memo running = offsets[chunk];
+      for (std::size_t i = chunk_begin; i != chunk_end; ++i) {
+        if (is_exclusive) {
+          Memo const next = function(running, first[i]);
+          first[i] = running;
+          running = next;
+        } else {
+          running = seeded ? function(running, first[i]) : Memo(first[i]);
+          first[i] = running;
+          seeded = true;
+        }
+      }
+    }
+  });
+}
+}  // namespace helper
+
+template<typename Container, typename Function>
+void scan_in_place_parallel(
+    Container& container,
+    Function function,
+    unsigned workers) {
+  UNDERSCORE_PROFILE("scan_in_place_parallel", container);
+  helper::parallel_scan(
+      container,
+      function,
+      typename Container::value_type(),
+      false,
+      false,
+      workers);
+}
+
+template<typename Container, typename Function>
+void scan_in_place_parallel(Container& container, Function function) {
+  scan_in_place_parallel(container, function, 0);
+}
+
+template<typename Container, typename Function, typename Memo>
+void exclusive_scan_in_place_parallel(
+    Container& container,
+    Function function,
+    Memo memo,
+    unsigned workers) {
+  UNDERSCORE_PROFILE("exclusive_scan_in_place_parallel", container);
+  helper::parallel_scan(container, function, memo, true, true, workers);
+}
+
+template<typename Container, typename Function, typename Memo>
+void exclusive_scan_in_place_parallel(
+    Container& container,
+    Function function,
+    Memo memo) {
+  exclusive_scan_in_place_parallel(container, function, memo, 0);
+}
+#endif
+
+// find/detect
+template<typename Container, typename Predicate>
+typename Container::iterator find(Container& container, 
+    Predicate predicate) {
+  UNDERSCORE_PROFILE("find", container);
+  return std::find_if(container.begin(), container.end(), predicate);
+}
+
+template<typename Container, typename Predicate>
+typename Container::iterator detect(Container& container, 
+    Predicate predicate) {
+  return find(container, predicate);
+}
+
+#if __cplusplus >= 201103L
+// find_parallel/detect_parallel
+// Finds the first element in a random access container that passes the
+// predicate, like find, with several threads. The workers claim blocks in
+// order from a shared counter and record the lowest index they have matched,
+// and a worker stops once the next block starts past that index, so the scan
+// ends shortly after the first match instead of covering the whole input. If
+// the predicate throws, the other workers are cancelled and the exception is
+// rethrown. Inputs too small to be worth splitting are searched sequentially.
+// Passing 0 workers uses the hardware concurrency. The predicate must be safe
+// to call concurrently.
+namespace helper {
+std::size_t const kMinimumParallelFind = 1 << 14;
+std::size_t const kParallelFindBlock = 1 << 12;
+
+// Lowers index to value unless it is already lower.
+inline void store_min(std::atomic<std::size_t>& index, std::size_t value) {
+  std::size_t current = index.load(std::memory_order_relaxed);
+  while (value < current &&
+      !index.compare_exchange_weak(
+          current,
+          value,
+          std::memory_order_relaxed)) {
+  }
+}
+}  // namespace helper
+
+template<typename Container, typename Predicate>
+typename Container::iterator find_parallel(
+    Container& container,
+    Predicate predicate,
+    unsigned workers) {
+  UNDERSCORE_PROFILE("find_parallel", container);
+  typename Container::iterator const first = container.begin();
+  std::size_t const count = container.size();
+  if (workers == 0) {
+    workers = helper::default_workers();
+  }
+  if (workers < 2 || count < helper::kMinimumParallelFind) {
+    return std::find_if(first, container.end(), predicate);
+  }
+
+  std::atomic<std::size_t> next_block(0);
+  std::atomic<std::size_t> lowest(count);
+  std::atomic<bool> cancelled(false);
+  std::exception_ptr error;
+  helper::parallel_for(workers, workers, [&](std::size_t, std::size_t) {
+    try {
+      for (;;) {
+        std::size_t const begin = helper::kParallelFindBlock *
+            next_block.fetch_add(1, std::memory_order_relaxed);
+        if (begin >= lowest.load(std::memory_order_relaxed) ||
+            cancelled.load(std::memory_order_relaxed)) {
+          return;
+        }
+        std::size_t const end =
+            std::min(begin + helper::kParallelFindBlock, count);
+        for (std::size_t i = begin; i != end; ++i) {
+          if (predicate(first[i])) {
+            helper::store_min(lowest, i);
+            return;
+          }
+        }
+      }
+    } catch (...) {
+      // Keeps the first exception and stops the other workers.
+      if (!cancelled.exchange(true)) {
+        error = std::current_exception();
+      }
+    }
+  });
+  if (error) {
+    std::rethrow_exception(error);
+  }
+  return first + lowest.load();
+}
+
+template<typename Container, typename Predicate>
+typename Container::iterator find_parallel(
+    Container& container,
+    Predicate predicate) {
+  return find_parallel(container, predicate, 0);
+}
+
+template<typename Container, typename Predicate>
+typename Container::iterator detect_parallel(
+    Container& container,
+    Predicate predicate,
+    unsigned workers) {
+  return find_parallel(container, predicate, workers);
+}
+
+template<typename Container, typename Predicate>
+typename Container::iterator detect_parallel(
+    Container& container,
+    Predicate predicate) {
+  return find_parallel(container, predicate, 0);
+}
+#endif
+
+namespace helper {
+// The in-place variants below mutate a container the caller already owns
+// instead of building a new ResultContainer, so that cleanup steps don't have
+// to allocate.
+
+// Sequence containers are compacted with the erase-remove idiom, which shifts
+// the kept elements down and trims the tail without allocating.
+template<typename Container, typename Predicate>
+typename enable_if<
+  !IsAssociative<Container>::value,
+  void>::type erase_if(Container& container, Predicate predicate) {
+  container.erase(
+      std::remove_if(container.begin(), container.end(), predicate),
+      container.end());
+}
+
+// The elements of associative containers can't be reassigned, so the
+// matching nodes are unlinked one at a time instead.
+template<typename Container, typename Predicate>
+typename enable_if<
+  IsAssociative<Container>::value,
+  void>::type erase_if(Container& container, Predicate predicate) {
+  for (typename Container::iterator i = container.begin();
+      i != container.end();) {
+    if (predicate(*i)) {
+      container.erase(i++);
+    } else {
+      ++i;
+    }
+  }
+}
+
+template<typename Predicate>
+class Negate {
+ public:
+  Negate(Predicate const& predicate) : predicate_(predicate) {
+  }
+
+  template<typename Argument>
+  bool operator()(Argument const& argument) const {
+    return !predicate_(argument);
+  }
+
+ private:
+  Predicate predicate_;
+};
+
+template<typename Predicate>
+Negate<Predicate> negate(Predicate const& predicate) {
+  return Negate<Predicate>(predicate);
+}
+}  // namespace helper
+
+// filter/select
+template<typename ResultContainer, typename Container, typename Predicate>
+ResultContainer filter(Container const& container, Predicate predicate) {
+  UNDERSCORE_PROFILE("filter", container);
+  ResultContainer result;
+  for (typename Container::const_iterator i = container.begin();
+      i != container.end();
+      ++i) {
+    if (predicate(*i)) {
+      helper::add_to_container(result, *i);
+    }
+  }
+  return result;
+}
+
+template<typename ResultContainer, typename Container, typename Predicate>
+ResultContainer select(Container const& container, Predicate predicate) {
+  return filter<ResultContainer>(container, predicate);
+}
+
+template<typename ResultContainer,
+    typename Container,
+    typename Predicate,
+    typename Allocator>
+ResultContainer filter(
+    Container const& container,
+    Predicate predicate,
+    Allocator const& allocator) {
+  UNDERSCORE_PROFILE("filter", container);
+  ResultContainer result(allocator);
+  for (typename Container::const_iterator i = container.begin();
+      i != container.end();
+      ++i) {
+    if (predicate(*i)) {
+      helper::add_to_container(result, *i);
+    }
+  }
+  return result;
+}
+
+template<typename ResultContainer,
+    typename Container,
+    typename Predicate,
+    typename Allocator>
+ResultContainer select(
+    Container const& container,
+    Predicate predicate,
+    Allocator const& allocator) {
+  return filter<ResultContainer>(container, predicate, allocator);
+}
+
+// filter_in_place/select_in_place
+template<typename Container, typename Predicate>
+void filter_in_place(Container& container, Predicate predicate) {
+  UNDERSCORE_PROFILE("filter_in_place", container);
+  helper::erase_if(container, helper::negate(predicate));
+}
+
+template<typename Container, typename Predicate>
+void select_in_place(Container& container, Predicate predicate) {
+  filter_in_place(container, predicate);
+}
+
+// reject
+template<typename ResultContainer, typename Container, typename Predicate>
+ResultContainer reject(Container const& container, Predicate predicate) {
+  UNDERSCORE_PROFILE("reject", container);
+  ResultContainer result;
+  for (typename Container::const_iterator i = container.begin();
+      i != container.end();
+      ++i) {
+    if (!predicate(*i)) {
+      helper::add_to_container(result, *i);
+    }
+  }
+  return result;
+}
+
+template<typename ResultContainer,
+    typename Container,
+    typename Predicate,
+    typename Allocator>
+ResultContainer reject(
+    Container const& container,
+    Predicate predicate,
+    Allocator const& allocator) {
+  UNDERSCORE_PROFILE("reject", container);
+  return filter<ResultContainer>(
+      container,
+      helper::negate(predicate),
+      allocator);
+}
+
+// reject_in_place
+template<typename Container, typename Predicate>
+void reject_in_place(Container& container, Predicate predicate) {
+  UNDERSCORE_PROFILE("reject_in_place", container);
+  helper::erase_if(container, predicate);
+}
+
+// all/every
+template<typename Container, typename Predicate>
+bool all(Container const& container, Predicate predicate) {
+  UNDERSCORE_PROFILE("all", container);
+  for (typename Container::const_iterator i = container.begin();
+      i != container.end();
+      ++i) {
+    if (!predicate(*i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template<typename Container, typename Predicate>
+bool every(Container const& container, Predicate predicate) {
+  return all(container, predicate);
+}
+
+// any/some
+template<typename Container, typename Predicate>
+bool any(Container const& container, Predicate predicate) {
+  UNDERSCORE_PROFILE("any", container);
+  for (typename Container::const_iterator i = container.begin();
+      i != container.end();
+      ++i) {
+    if (predicate(*i)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+template<typename Container, typename Predicate>
+bool some(Container const& container, Predicate predicate) {
+  return any(container, predicate);
+}
+
+// include/contains
+template<typename Container>
+bool include(Container const& container, typename Container::value_type value) {
+  UNDERSCORE_PROFILE("include", container);
+  return std::find(container.begin(), container.end(), value) !=
+      container.end();
+}
+
+template<typename Container>
+bool contains(Container const& container, typename Container::value_type value) {
+  return include(container, value);
+}
+
+// invoke
+template<typename ResultContainer, typename Container, typename Function>
+typename helper::enable_if<
+    !helper::is_void<ResultContainer>::value,
+    ResultContainer>::type invoke(Container container, Function function) {
+  UNDERSCORE_PROFILE("invoke", container);
+  ResultContainer result;
+  for (typename Container::iterator i = container.begin();
+      i != container.end();
+      ++i) {
+    helper::add_to_container(result, (*i.*function)());
+  }
+  return result;
+}
+
+template<typename ResultContainer,
+    typename Container,
+    typename Function,
+    typename Allocator>
+ResultContainer invoke(
+    Container container,
+    Function function,
+    Allocator const& allocator) {
+  UNDERSCORE_PROFILE("invoke", container);
+  ResultContainer result(allocator);
+  for (typename Container::iterator i = container.begin();
+      i != container.end();
+      ++i) {
+    helper::add_to_container(result, (*i.*function)());
+  }
+  return result;
+}
+
+template<typename ResultContainer, typename Container, typename Function>
+typename helper::enable_if<
+    helper::is_void<ResultContainer>::value,
+    void>::type invoke(Container container, Function function) {
+  UNDERSCORE_PROFILE("invoke", container);
+  for (typename Container::iterator i = container.begin();
+      i != container.end();
+      ++i) {
+    (*i.*function)();
+  }
+}
+
+// invoke_grouped
+// For containers of pointers to polymorphic objects (raw pointers,
+// std::unique_ptr or std::shared_ptr), the elements are first grouped by
+// dynamic type, or by a user-supplied tag, and each group is invoked together
+// so that the same override runs back to back. The pointers are dereferenced
+// in place and never copied. Groups run in the order their first element
+// appears, and within a group elements keep their container order.
+//
+// Grouping is a counting sort in two passes over the container. Each tag is
+// compared with the previous element's tag first and otherwise looked up in
+// a sorted index of the distinct tags seen so far, so for k distinct tags
+// grouping n elements takes O(n log k), plus O(k^2) to build the index. That
+// suits the handful of types a loop like this sees, not tags that are unique
+// per element. Tags need only operator<.
+//
+// Loops that run every frame can keep an InvokeGroupedBuffer and pass it to
+// each call, so that grouping stops allocating once the buffer has grown to
+// the largest container.
+namespace helper {
+template<typename Pointer>
+struct Pointee {
+  typedef typename Pointer::element_type type;
+};
+
+template<typename T>
+struct Pointee<T*> {
+  typedef T type;
+};
+
+class DynamicType {
+ public:
+  DynamicType(std::type_info const& info) : info_(&info) {
+  }
+
+  bool operator<(DynamicType const& other) const {
+    return info_ != other.info_ && info_->before(*other.info_);
+  }
+
+  bool operator==(DynamicType const& other) const {
+    return *info_ == *other.info_;
+  }
+
+ private:
+  std::type_info const* info_;
+};
+
+struct DynamicTypeOf {
+  template<typename T>
+  DynamicType operator()(T const& value) const {
+    return DynamicType(typeid(value));
+  }
+};
+
+template<typename Key>
+bool same_key(Key const& left, Key const& right) {
+  return !(left < right) && !(right < left);
+}
+
+// One comparison of type_info objects instead of two calls to before.
+inline bool same_key(DynamicType const& left, DynamicType const& right) {
+  return left == right;
+}
+
+// Orders the (tag, group) entries of a grouping index by tag.
+struct GroupKeyLess {
+  template<typename Key>
+  bool operator()(std::pair<Key, std::size_t> const& entry, Key const& key)
+      const {
+    return entry.first < key;
+  }
+};
+}  // namespace helper
+
+template<typename Element, typename Key = helper::DynamicType>
+class InvokeGroupedBuffer {
+ public:
+  template<typename Container, typename Tag>
+  void group(Container& container, Tag tag) {
+    index_.clear();
+    starts_.clear();
+    groups_.resize(container.size());
+    std::size_t group = 0;
+    std::size_t previous = 0;
+    std::size_t index = 0;
+    for (typename Container::iterator i = container.begin();
+        i != container.end();
+        ++i, ++index) {
+      Key const key = tag(**i);
+      if (index_.empty() || !helper::same_key(key, index_[previous].first)) {
+        typename std::vector<std::pair<Key, std::size_t> >::iterator entry =
+            std::lower_bound(
+                index_.begin(),
+                index_.end(),
+                key,
+                helper::GroupKeyLess());
+        if (entry == index_.end() || key < entry->first) {
+          entry = index_.insert(entry, std::make_pair(key, starts_.size()));
+          starts_.push_back(0);
+        }
+        group = entry->second;
+        previous = static_cast<std::size_t>(entry - index_.begin());
+      }
+      groups_[index] = group;
+      ++starts_[group];
+    }
+
+    std::size_t start = 0;
+    for (std::size_t g = 0; g != starts_.size(); ++g) {
+      std::size_t const count = starts_[g];
+      starts_[g] = start;
+      start += count;
+    }
+
+    grouped_.resize(container.size());
+    index = 0;
+    for (typename Container::iterator i = container.begin();
+        i != container.end();
+        ++i, ++index) {
+      grouped_[starts_[groups_[index]]++] = &**i;
+    }
+  }
+
+  // The elements in grouped order, as left by the last call to group.
+  std::vector<Element*> const& grouped() const {
+    return grouped_;
+  }
+
+ private:
+  // The distinct tags, sorted, each with its group.
+  std::vector<std::pair<Key, std::size_t> > index_;
+  std::vector<std::size_t> starts_;
+  std::vector<std::size_t> groups_;
+  std::vector<Element*> grouped_;
+};
+
+namespace helper {
+template<typename Element, typename Function>
+void invoke_range(
+    std::vector<Element*> const& grouped,
+    std::size_t begin,
+    std::size_t end,
+    Function function) {
+  for (std::size_t i = begin; i != end; ++i) {
+    (grouped[i]->*function)();
+  }
+}
+}  // namespace helper
+
+template<typename Key,
+    typename Container,
+    typename Function,
+    typename Tag,
+    typename Element>
+void invoke_grouped(
+    Container& container,
+    Function function,
+    Tag tag,
+    InvokeGroupedBuffer<Element, Key>& buffer) {
+  UNDERSCORE_PROFILE("invoke_grouped", container);
+  buffer.group(container, tag);
+  helper::invoke_range(buffer.grouped(), 0, buffer.grouped().size(), function);
+}
+
+template<typename Key, typename Container, typename Function, typename Tag>
+void invoke_grouped(Container& container, Function function, Tag tag) {
+  InvokeGroupedBuffer<
+      typename helper::Pointee<typename Container::value_type>::type,
+      Key> buffer;
+  invoke_grouped<Key>(container, function, tag, buffer);
+}
+
+template<typename Container, typename Function, typename Element>
+void invoke_grouped(
+    Container& container,
+    Function function,
+    InvokeGroupedBuffer<Element, helper::DynamicType>& buffer) {
+  invoke_grouped<helper::DynamicType>(
+      container,
+      function,
+      helper::DynamicTypeOf(),
+      buffer);
+}
+
+template<typename Container, typename Function>
+void invoke_grouped(Container& container, Function function) {
+  invoke_grouped<helper::DynamicType>(
+      container,
+      function,
+      helper::DynamicTypeOf());
+}
+
+#if __cplusplus >= 201103L
+// invoke_grouped_parallel
+// The grouped order is split into contiguous ranges, one per worker, so each
+// thread still walks whole runs of a single type. Passing 0 workers uses the
+// hardware concurrency. The invoked function must be safe to call
+// concurrently on distinct elements. If it throws, the first exception is
+// rethrown after every worker has finished.
+template<typename Key,
+    typename Container,
+    typename Function,
+    typename Tag,
+    typename Element>
+void invoke_grouped_parallel(
+    Container& container,
+    Function function,
+    Tag tag,
+    unsigned workers,
+    InvokeGroupedBuffer<Element, Key>& buffer) {
+  UNDERSCORE_PROFILE("invoke_grouped_parallel", container);
+  buffer.group(container, tag);
+  std::vector<Element*> const& grouped = buffer.grouped();
+  helper::parallel_for(
+      grouped.size(),
+      workers,
+      [&grouped, function](std::size_t begin, std::size_t end) {
+        helper::invoke_range(grouped, begin, end, function);
+      });
+}
+
+template<typename Key, typename Container, typename Function, typename Tag>
+void invoke_grouped_parallel(
+    Container& container,
+    Function function,
+    Tag tag,
+    unsigned workers) {
+  InvokeGroupedBuffer<
+      typename helper::Pointee<typename Container::value_type>::type,
+      Key> buffer;
+  invoke_grouped_parallel<Key>(container, function, tag, workers, buffer);
+}
+
+template<typename Container, typename Function, typename Element>
+void invoke_grouped_parallel(
+    Container& container,
+    Function function,
+    unsigned workers,
+    InvokeGroupedBuffer<Element, helper::DynamicType>& buffer) {
+  invoke_grouped_parallel<helper::DynamicType>(
+      container,
+      function,
+      helper::DynamicTypeOf(),
+      workers,
+      buffer);
+}
+
+template<typename Container, typename Function>
+void invoke_grouped_parallel(
+    Container& container,
+    Function function,
+    unsigned workers) {
+  invoke_grouped_parallel<helper::DynamicType>(
+      container,
+      function,
+      helper::DynamicTypeOf(),
+      workers);
+}
+#endif
+
+// pluck
+// Called like `_::pluck<vector<int>>(container, &value_type::member)`
+template<typename ResultContainer, typename Container, typename Member>
+ResultContainer pluck(Container const& container, Member member) {
+  UNDERSCORE_PROFILE("pluck", container);
+  ResultContainer result;
+  for (typename Container::const_iterator i = container.begin();
+      i != container.end();
+      ++i) {
+    helper::add_to_container(result, *i.*member);
+  }
+  return result;
+}
+
+template<typename ResultContainer,
+    typename Container,
+    typename Member,
+    typename Allocator>
+ResultContainer pluck(
+    Container const& container,
+    Member member,
+    Allocator const& allocator) {
+  UNDERSCORE_PROFILE("pluck", container);
+  ResultContainer result(allocator);
+  for (typename Container::const_iterator i = container.begin();
+      i != container.end();
+      ++i) {
+    helper::add_to_container(result, *i.*member);
+  }
+  return result;
+}
+
+// max
+template<typename Container>
+typename Container::iterator max(Container container) {
+  UNDERSCORE_PROFILE("max", container);
+  if (container.begin() == container.end()) {
+    return container.end();
+  }
+
+  typename Container::iterator max = container.begin();
+  for (typename Container::iterator i = ++container.begin();
+      i != container.end();
+      ++i) {
+    if (*max < *i) {
+      max = i;
+    }
+  }
+  return max;
+}
+
+template<typename Compared, typename Container, typename Function>
+typename Container::iterator max(Container container, Function function) {
+  UNDERSCORE_PROFILE("max", container);
+  if (container.begin() == container.end()) {
+    return container.end();
+  }
+
+  struct {
+    typename Container::iterator position;
+    Compared computed;
+  } max = {
+    container.begin(),
+    function(*container.begin())
+  };
+
+  for (typename Container::iterator i = ++container.begin();
+      i != container.end();
+      ++i) {
+    Compared computed = function(*i);
+    if (max.computed < computed) {
+      max.position = i;
+      max.computed = computed;
+    }
+  }
+  return max.position;
+}
+
+// min
+template<typename Container>
+typename Container::iterator min(Container container) {
+  UNDERSCORE_PROFILE("min", container);
+  if (container.begin() == container.end()) {
+    return container.end();
+  }
+
+  typename Container::iterator min = container.begin();
+  for (typename Container::iterator i = ++container.begin();
+      i != container.end();
+      ++i) {
+    if (*i < *min) {
+      min = i;
+    }
+  }
+  return min;
+}
+
+template<typename Compared, typename Container, typename Function>
+typename Container::iterator min(Container container, Function function) {
+  UNDERSCORE_PROFILE("min", container);
+  if (container.begin() == container.end()) {
+    return container.end();
+  }
+
+  struct {
+    typename Container::iterator position;
+    Compared computed;
+  } min = {
+    container.begin(),
+    function(*container.begin())
+  };
+
+  for (typename Container::iterator i = ++container.begin();
+      i != container.end();
+      ++i) {
+    Compared computed = function(*i);
+    if (computed < min.computed) {
+      min.position = i;
+      min.computed = computed;
+    }
+  }
+  return min.position;
+}
+
+// sort_by
+template<typename Container, typename Function>
+Container sort_by(Container const& container, Function function) {
+  UNDERSCORE_PROFILE("sort_by", container);
+  std::vector<typename Container::value_type> to_sort(container.begin(),
+      container.end());
+  UNDERSCORE_COUNT_SCRATCH(to_sort);
+  std::sort(to_sort.begin(), to_sort.end(), function);
+  Container result(to_sort.begin(), to_sort.end());
+  UNDERSCORE_COUNT_RESULT(result);
+  return result;
+}
+
+template<typename ResultContainer,
+    typename Container,
+    typename Function,
+    typename Allocator>
+ResultContainer sort_by(
+    Container const& container,
+    Function function,
+    Allocator const& allocator) {
+  UNDERSCORE_PROFILE("sort_by", container);
+  typename helper::ScratchVector<
+      typename Container::value_type,
+      Allocator>::type to_sort(container.begin(), container.end(), allocator);
+  UNDERSCORE_COUNT_SCRATCH(to_sort);
+  std::sort(to_sort.begin(), to_sort.end(), function);
+  ResultContainer result(allocator);
+  helper::append_range(result, to_sort.begin(), to_sort.end());
+  return result;
+}
+
+// group_by
+template<typename Key, typename Container, typename Function>
+std::multimap<Key, typename Container::value_type> group_by(
+    Container const& container,
+    Function function) {
+  UNDERSCORE_PROFILE("group_by", container);
+  std::multimap<Key, typename Container::value_type> result;
+  for (typename Container::const_iterator i = container.begin();
+      i != container.end();
+      ++i) {
+    UNDERSCORE_COUNT_ADDITION(result);
+    result.insert(
+        std::pair<Key, typename Container::value_type>(function(*i), *i));
+  }
+  return result;
+}
+
+template<typename Key,
+    typename Container,
+    typename Function,
+    typename Allocator>
+std::multimap<
+    Key,
+    typename Container::value_type,
+    std::less<Key>,
+    typename helper::Rebind<
+        Allocator,
+        std::pair<Key const, typename Container::value_type> >::type>
+group_by(
+    Container const& container,
+    Function function,
+    Allocator const& allocator) {
+  UNDERSCORE_PROFILE("group_by", container);
+  typedef std::pair<Key const, typename Container::value_type> Entry;
+  std::multimap<
+      Key,
+      typename Container::value_type,
+      std::less<Key>,
+      typename helper::Rebind<Allocator, Entry>::type> result(
+          std::less<Key>(),
+          allocator);
+  for (typename Container::const_iterator i = container.begin();
+      i != container.end();
+      ++i) {
+    UNDERSCORE_COUNT_ADDITION(result);
+    result.insert(Entry(function(*i), *i));
+  }
+  return result;
+}
+
+// sorted_index
+template<typename Container>
+typename Container::iterator sorted_index(
+    Container container,
+    typename Container::value_type const& value) {
+  UNDERSCORE_PROFILE("sorted_index", container);
+  return std::upper_bound(container.begin(), container.end(), value);
+}
+
+namespace helper {
+template<typename Argument, typename Function>
+class TransformCompare {
+ public:
+  TransformCompare(Function const& function) : function_(function) {
+  }
+
+  bool operator()(Argument const& left, Argument const& right) const {
+    return function_(left) < function_(right);
+  }
+
+ private:
+  Function function_;
+};
+}  // namespace helper
+
+template<typename Container, typename Function>
+typename Container::iterator sorted_index(
+  Container container,
+  typename Container::value_type const& value,
+  Function function) {
+  UNDERSCORE_PROFILE("sorted_index", container);
+  return std::upper_bound(
+      container.begin(),
+      container.end(),
+      value,
+      helper::TransformCompare<
+          typename Container::value_type,
+          Function>(function));
+}
+
+// shuffle
+// This assumes srand has already been called.
+template<typename ResultContainer, typename Container>
+ResultContainer shuffle(Container const& container) {
+  UNDERSCORE_PROFILE("shuffle", container);
+  std::vector<typename Container::value_type> deck(
+      container.begin(),
+      container.end());
+  UNDERSCORE_COUNT_SCRATCH(deck);
+  for (int i = deck.size() - 1; i > 1; --i) {
+    int j = std::rand() % (i + 1);
+    std::swap(deck[i], deck[j]);
+  }
+  ResultContainer result(deck.begin(), deck.end());
+  UNDERSCORE_COUNT_RESULT(result);
+  return result;
+}
+
+template<typename ResultContainer, typename Container, typename Allocator>
+ResultContainer shuffle(
+    Container const& container,
+    Allocator const& allocator) {
+  UNDERSCORE_PROFILE("shuffle", container);
+  typename helper::ScratchVector<
+      typename Container::value_type,
+      Allocator>::type deck(container.begin(), container.end(), allocator);
+  UNDERSCORE_COUNT_SCRATCH(deck);
+  for (int i = deck.size() - 1; i > 1; --i) {
+    int j = std::rand() % (i + 1);
+    std::swap(deck[i], deck[j]);
+  }
+  ResultContainer result(allocator);
+  helper::append_range(result, deck.begin(), deck.end());
+  return result;
+}
+
+// to_array
+template<typename Container>
+typename Container::value_type* to_array(Container const& container) {
+  UNDERSCORE_PROFILE("to_array", container);
+  typename Container::value_type* array =
+      new typename Container::value_type[container.size()];
+  struct {
+    int numeric;
+    typename Container::const_iterator iterator;
+  } i;
+  for (i.numeric = 0, i.iterator = container.begin();
+      i.iterator != container.end();
+      ++i.numeric, ++i.iterator) {
+    array[i.numeric] = *i.iterator;
+  }
+
+  return array;
+}
+
+// size
+template<typename Container>
+int size(Container const& container) {
+  return container.size();
+}
+
+}  // namespace underscore
+
+#endif  // UNDERSCORE_COLLECTIONS_H_
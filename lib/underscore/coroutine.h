@@ -0,0 +1,1057 @@
+#ifndef UNDERSCORE_COROUTINE_H_
+#define UNDERSCORE_COROUTINE_H_
+
+// A coroutine layer for Underscore. generator<T> is a lazy, single pass
+// source; async_generator<T> is one whose body can itself suspend, for
+// example to wait on I/O or to move to a ThreadPool, without blocking the
+// thread that is consuming it. Both work with map, filter, take, reduce and
+// each, and both can be wrapped with chain. Stages that should run
+// concurrently are separated with buffer, which moves the upstream stage onto
+// a ThreadPool and connects the two through a bounded queue: the producer
+// suspends while the queue is full and the consumer while it is empty.
+//
+// The values yielded by a generator are handed out by const reference and
+// are only valid until the generator is resumed again.
+//
+// This header requires C++20.
+
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "chaining.h"
+#include "parallel.h"
+
+namespace underscore {
+
+// generator
+template<typename T>
+class generator {
+ public:
+  typedef std::remove_cvref_t<T> value_type;
+
+  class promise_type {
+   public:
+    generator get_return_object() {
+      return generator(
+          std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+
+    std::suspend_always initial_suspend() noexcept {
+      return {};
+    }
+
+    std::suspend_always final_suspend() noexcept {
+      return {};
+    }
+
+    std::suspend_always yield_value(value_type const& value) noexcept {
+      value_ = std::addressof(value);
+      return {};
+    }
+
+    void return_void() {
+    }
+
+    void unhandled_exception() {
+      exception_ = std::current_exception();
+    }
+
+    value_type const& value() const {
+      return *value_;
+    }
+
+    void rethrow_if_failed() {
+      if (exception_) {
+        std::rethrow_exception(std::exchange(exception_, nullptr));
+      }
+    }
+
+   private:
+    value_type const* value_ = nullptr;
+    std::exception_ptr exception_;
+  };
+
+  class iterator {
+   public:
+    typedef std::input_iterator_tag iterator_category;
+    typedef generator::value_type value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef value_type const* pointer;
+    typedef value_type const& reference;
+
+    iterator() {
+    }
+
+    explicit iterator(std::coroutine_handle<promise_type> coroutine)
+        : coroutine_(coroutine) {
+    }
+
+    value_type const& operator*() const {
+      return coroutine_.promise().value();
+    }
+
+    value_type const* operator->() const {
+      return std::addressof(coroutine_.promise().value());
+    }
+
+    iterator& operator++() {
+      coroutine_ = advance(coroutine_);
+      return *this;
+    }
+
+    void operator++(int) {
+      ++*this;
+    }
+
+    bool operator==(iterator const& other) const {
+      return coroutine_ == other.coroutine_;
+    }
+
+    bool operator!=(iterator const& other) const {
+      return !(*this == other);
+    }
+
+   private:
+    std::coroutine_handle<promise_type> coroutine_;
+  };
+  typedef iterator const_iterator;
+
+  generator(generator&& other) noexcept
+      : coroutine_(std::exchange(other.coroutine_, nullptr)) {
+  }
+
+  generator& operator=(generator&& other) noexcept {
+    std::swap(coroutine_, other.coroutine_);
+    return *this;
+  }
+
+  ~generator() {
+    if (coroutine_) {
+      coroutine_.destroy();
+    }
+  }
+
+  iterator begin() {
+    return coroutine_ ? iterator(advance(coroutine_)) : iterator();
+  }
+
+  iterator end() {
+    return iterator();
+  }
+
+ private:
+  explicit generator(std::coroutine_handle<promise_type> coroutine)
+      : coroutine_(coroutine) {
+  }
+
+  // Resumes the coroutine and returns it, or a null handle once it has
+  // finished.
+  static std::coroutine_handle<promise_type> advance(
+      std::coroutine_handle<promise_type> coroutine) {
+    coroutine.resume();
+    if (coroutine.done()) {
+      coroutine.promise().rethrow_if_failed();
+      return nullptr;
+    }
+    return coroutine;
+  }
+
+  std::coroutine_handle<promise_type> coroutine_;
+};
+
+// map/filter/take/reduce/each for generators
+template<typename T, typename Function>
+generator<std::invoke_result_t<
+    Function&,
+    typename generator<T>::value_type const&> > map(
+    generator<T> source,
+    Function function) {
+  for (typename generator<T>::value_type const& value : source) {
+    co_yield function(value);
+  }
+}
+
+template<typename T, typename Predicate>
+generator<T> filter(generator<T> source, Predicate predicate) {
+  for (typename generator<T>::value_type const& value : source) {
+    if (predicate(value)) {
+      co_yield value;
+    }
+  }
+}
+
+template<typename T>
+generator<T> take(generator<T> source, std::size_t count) {
+  if (count == 0) {
+    co_return;
+  }
+  for (typename generator<T>::value_type const& value : source) {
+    co_yield value;
+    if (--count == 0) {
+      co_return;
+    }
+  }
+}
+
+template<typename T, typename Function, typename Memo>
+Memo reduce(generator<T> source, Function function, Memo memo) {
+  for (typename generator<T>::value_type const& value : source) {
+    memo = function(memo, value);
+  }
+  return memo;
+}
+
+template<typename T, typename Function>
+void each(generator<T> source, Function function) {
+  for (typename generator<T>::value_type const& value : source) {
+    function(value);
+  }
+}
+
+// Chaining a generator moves it along the chain, since it can only be
+// consumed once.
+template<typename T>
+class Wrapper<generator<T> > {
+ public:
+  typedef generator<T> value_type;
+
+  explicit Wrapper(generator<T> source) : source_(std::move(source)) {
+  }
+
+  generator<T> value() {
+    return std::move(source_);
+  }
+
+  template<typename Function>
+  void each(Function function) {
+    underscore::each(std::move(source_), function);
+  }
+
+  template<typename Function>
+  auto map(Function function) {
+    auto mapped = underscore::map(std::move(source_), function);
+    return Wrapper<decltype(mapped)>(std::move(mapped));
+  }
+
+  template<typename Predicate>
+  Wrapper filter(Predicate predicate) {
+    return Wrapper(underscore::filter(std::move(source_), predicate));
+  }
+
+  Wrapper take(std::size_t count) {
+    return Wrapper(underscore::take(std::move(source_), count));
+  }
+
+  template<typename Function, typename Memo>
+  Wrapper<Memo> reduce(Function function, Memo memo) {
+    return chain(underscore::reduce(std::move(source_), function, memo));
+  }
+
+ private:
+  generator<T> source_;
+};
+
+template<typename T>
+Wrapper<generator<T> > chain(generator<T> source) {
+  return Wrapper<generator<T> >(std::move(source));
+}
+
+// ThreadPool
+// A fixed set of worker threads that resume the coroutines scheduled on it.
+// `co_await pool.schedule()` moves the awaiting coroutine onto the pool.
+// Work that is still queued when the pool is destroyed is run first.
+class ThreadPool {
+ public:
+  explicit ThreadPool(unsigned threads = 0) : stopping_(false) {
+    if (threads == 0) {
+      threads = helper::default_workers();
+    }
+    threads_.reserve(threads);
+    for (unsigned i = 0; i < threads; ++i) {
+      threads_.emplace_back([this]() {
+        run();
+      });
+    }
+  }
+
+  ThreadPool(ThreadPool const&) = delete;
+  ThreadPool& operator=(ThreadPool const&) = delete;
+
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    ready_.notify_all();
+    for (std::thread& thread : threads_) {
+      thread.join();
+    }
+  }
+
+  class ScheduleAwaiter {
+   public:
+    explicit ScheduleAwaiter(ThreadPool& pool) : pool_(pool) {
+    }
+
+    bool await_ready() const noexcept {
+      return false;
+    }
+
+    void await_suspend(std::coroutine_handle<> coroutine) {
+      pool_.post(coroutine);
+    }
+
+    void await_resume() const noexcept {
+    }
+
+   private:
+    ThreadPool& pool_;
+  };
+
+  ScheduleAwaiter schedule() {
+    return ScheduleAwaiter(*this);
+  }
+
+  void post(std::coroutine_handle<> coroutine) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      queue_.push_back(coroutine);
+    }
+    ready_.notify_one();
+  }
+
+ private:
+  void run() {
+    for (;;) {
+      std::coroutine_handle<> coroutine;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ready_.wait(lock, [this]() {
+          return stopping_ || !queue_.empty();
+        });
+        if (queue_.empty()) {
+          return;
+        }
+        coroutine = queue_.front();
+        queue_.pop_front();
+      }
+      coroutine.resume();
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable ready_;
+  std::deque<std::coroutine_handle<> > queue_;
+  bool stopping_;
+  std::vector<std::thread> threads_;
+};
+
+// task
+// A lazily started coroutine producing a single value. Awaiting a task starts
+// it, and the awaiting coroutine is resumed when it finishes. sync_wait runs a
+// task to completion from ordinary code.
+template<typename T = void>
+class task;
+
+namespace helper {
+struct TaskFinalAwaiter {
+  bool await_ready() const noexcept {
+    return false;
+  }
+
+  template<typename Promise>
+  std::coroutine_handle<> await_suspend(
+      std::coroutine_handle<Promise> coroutine) noexcept {
+    std::coroutine_handle<> continuation = coroutine.promise().continuation;
+    return continuation ? continuation : std::noop_coroutine();
+  }
+
+  void await_resume() const noexcept {
+  }
+};
+
+struct TaskPromiseBase {
+  std::suspend_always initial_suspend() noexcept {
+    return {};
+  }
+
+  TaskFinalAwaiter final_suspend() noexcept {
+    return {};
+  }
+
+  void unhandled_exception() {
+    exception = std::current_exception();
+  }
+
+  void rethrow_if_failed() {
+    if (exception) {
+      std::rethrow_exception(exception);
+    }
+  }
+
+  std::coroutine_handle<> continuation;
+  std::exception_ptr exception;
+};
+
+template<typename T>
+struct TaskPromise : TaskPromiseBase {
+  task<T> get_return_object();
+
+  template<typename Value>
+  void return_value(Value&& returned) {
+    value.emplace(std::forward<Value>(returned));
+  }
+
+  T result() {
+    rethrow_if_failed();
+    return std::move(*value);
+  }
+
+  std::optional<T> value;
+};
+
+template<>
+struct TaskPromise<void> : TaskPromiseBase {
+  task<void> get_return_object();
+
+  void return_void() {
+  }
+
+  void result() {
+    rethrow_if_failed();
+  }
+};
+}  // namespace helper
+
+template<typename T>
+class task {
+ public:
+  typedef helper::TaskPromise<T> promise_type;
+
+  explicit task(std::coroutine_handle<promise_type> coroutine)
+      : coroutine_(coroutine) {
+  }
+
+  task(task&& other) noexcept
+      : coroutine_(std::exchange(other.coroutine_, nullptr)) {
+  }
+
+  task& operator=(task&& other) noexcept {
+    std::swap(coroutine_, other.coroutine_);
+    return *this;
+  }
+
+  ~task() {
+    if (coroutine_) {
+      coroutine_.destroy();
+    }
+  }
+
+  class Awaiter {
+   public:
+    explicit Awaiter(std::coroutine_handle<promise_type> coroutine)
+        : coroutine_(coroutine) {
+    }
+
+    bool await_ready() const noexcept {
+      return coroutine_.done();
+    }
+
+    std::coroutine_handle<> await_suspend(
+        std::coroutine_handle<> awaiting) noexcept {
+      coroutine_.promise().continuation = awaiting;
+      return coroutine_;
+    }
+
+    T await_resume() {
+      return coroutine_.promise().result();
+    }
+
+   private:
+    std::coroutine_handle<promise_type> coroutine_;
+  };
+
+  Awaiter operator co_await() && {
+    return Awaiter(coroutine_);
+  }
+
+ private:
+  std::coroutine_handle<promise_type> coroutine_;
+};
+
+namespace helper {
+template<typename T>
+task<T> TaskPromise<T>::get_return_object() {
+  return task<T>(
+      std::coroutine_handle<TaskPromise<T> >::from_promise(*this));
+}
+
+inline task<void> TaskPromise<void>::get_return_object() {
+  return task<void>(
+      std::coroutine_handle<TaskPromise<void> >::from_promise(*this));
+}
+
+// The coroutine sync_wait uses to await a task; it signals the waiting
+// thread once it reaches its final suspension point.
+class SyncWaitTask {
+ public:
+  struct promise_type {
+    SyncWaitTask get_return_object() {
+      return SyncWaitTask(
+          std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+
+    std::suspend_always initial_suspend() noexcept {
+      return {};
+    }
+
+    auto final_suspend() noexcept {
+      struct Signal {
+        bool await_ready() const noexcept {
+          return false;
+        }
+
+        void await_suspend(
+            std::coroutine_handle<promise_type> coroutine) noexcept {
+          promise_type& promise = coroutine.promise();
+          std::lock_guard<std::mutex> lock(promise.mutex);
+          promise.finished = true;
+          promise.signal.notify_all();
+        }
+
+        void await_resume() const noexcept {
+        }
+      };
+      return Signal();
+    }
+
+    void return_void() {
+    }
+
+    void unhandled_exception() {
+      exception = std::current_exception();
+    }
+
+    std::mutex mutex;
+    std::condition_variable signal;
+    bool finished = false;
+    std::exception_ptr exception;
+  };
+
+  explicit SyncWaitTask(std::coroutine_handle<promise_type> coroutine)
+      : coroutine_(coroutine) {
+  }
+
+  SyncWaitTask(SyncWaitTask&& other) noexcept
+      : coroutine_(std::exchange(other.coroutine_, nullptr)) {
+  }
+
+  ~SyncWaitTask() {
+    if (coroutine_) {
+      coroutine_.destroy();
+    }
+  }
+
+  void run() {
+    coroutine_.resume();
+    promise_type& promise = coroutine_.promise();
+    std::unique_lock<std::mutex> lock(promise.mutex);
+    promise.signal.wait(lock, [&promise]() {
+      return promise.finished;
+    });
+    if (promise.exception) {
+      std::rethrow_exception(promise.exception);
+    }
+  }
+
+ private:
+  std::coroutine_handle<promise_type> coroutine_;
+};
+
+template<typename T>
+SyncWaitTask sync_wait_for(task<T>& awaited, std::optional<T>& result) {
+  result.emplace(co_await std::move(awaited));
+}
+
+inline SyncWaitTask sync_wait_for(task<void>& awaited) {
+  co_await std::move(awaited);
+}
+}  // namespace helper
+
+// sync_wait
+template<typename T>
+T sync_wait(task<T> awaited) {
+  std::optional<T> result;
+  helper::sync_wait_for(awaited, result).run();
+  return std::move(*result);
+}
+
+inline void sync_wait(task<void> awaited) {
+  helper::sync_wait_for(awaited).run();
+}
+
+// async_generator
+// Consumed from another coroutine with
+// `while (auto const* value = co_await source.next()) { ... }`; next yields a
+// null pointer once the generator has finished.
+template<typename T>
+class async_generator {
+ public:
+  typedef std::remove_cvref_t<T> value_type;
+
+  class promise_type {
+   public:
+    async_generator get_return_object() {
+      return async_generator(
+          std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+
+    std::suspend_always initial_suspend() noexcept {
+      return {};
+    }
+
+    struct ResumeConsumer {
+      bool await_ready() const noexcept {
+        return false;
+      }
+
+      std::coroutine_handle<> await_suspend(
+          std::coroutine_handle<promise_type> coroutine) noexcept {
+        return coroutine.promise().consumer_;
+      }
+
+      void await_resume() const noexcept {
+      }
+    };
+
+    ResumeConsumer final_suspend() noexcept {
+      value_ = nullptr;
+      return {};
+    }
+
+    ResumeConsumer yield_value(value_type const& value) noexcept {
+      value_ = std::addressof(value);
+      return {};
+    }
+
+    void return_void() {
+    }
+
+    void unhandled_exception() {
+      exception_ = std::current_exception();
+    }
+
+    value_type const* value() {
+      if (exception_) {
+        std::rethrow_exception(std::exchange(exception_, nullptr));
+      }
+      return value_;
+    }
+
+   private:
+    friend class async_generator;
+
+    value_type const* value_ = nullptr;
+    std::coroutine_handle<> consumer_;
+    std::exception_ptr exception_;
+  };
+
+  class NextAwaiter {
+   public:
+    explicit NextAwaiter(std::coroutine_handle<promise_type> producer)
+        : producer_(producer) {
+    }
+
+    bool await_ready() const noexcept {
+      return !producer_ || producer_.done();
+    }
+
+    std::coroutine_handle<> await_suspend(
+        std::coroutine_handle<> consumer) noexcept {
+      producer_.promise().consumer_ = consumer;
+      return producer_;
+    }
+
+    value_type const* await_resume() {
+      return producer_ ? producer_.promise().value() : nullptr;
+    }
+
+   private:
+    std::coroutine_handle<promise_type> producer_;
+  };
+
+  async_generator(async_generator&& other) noexcept
+      : coroutine_(std::exchange(other.coroutine_, nullptr)) {
+  }
+
+  async_generator& operator=(async_generator&& other) noexcept {
+    std::swap(coroutine_, other.coroutine_);
+    return *this;
+  }
+
+  ~async_generator() {
+    if (coroutine_) {
+      coroutine_.destroy();
+    }
+  }
+
+  NextAwaiter next() {
+    return NextAwaiter(coroutine_);
+  }
+
+ private:
+  explicit async_generator(std::coroutine_handle<promise_type> coroutine)
+      : coroutine_(coroutine) {
+  }
+
+  std::coroutine_handle<promise_type> coroutine_;
+};
+
+// map/filter/take/reduce/each for async generators
+template<typename T, typename Function>
+async_generator<std::invoke_result_t<
+    Function&,
+    typename async_generator<T>::value_type const&> > map(
+    async_generator<T> source,
+    Function function) {
+  while (auto const* value = co_await source.next()) {
+    co_yield function(*value);
+  }
+}
+
+template<typename T, typename Predicate>
+async_generator<T> filter(async_generator<T> source, Predicate predicate) {
+  while (auto const* value = co_await source.next()) {
+    if (predicate(*value)) {
+      co_yield *value;
+    }
+  }
+}
+
+template<typename T>
+async_generator<T> take(async_generator<T> source, std::size_t count) {
+  for (; count; --count) {
+    auto const* value = co_await source.next();
+    if (!value) {
+      co_return;
+    }
+    co_yield *value;
+  }
+}
+
+template<typename T, typename Function, typename Memo>
+task<Memo> reduce(async_generator<T> source, Function function, Memo memo) {
+  while (auto const* value = co_await source.next()) {
+    memo = function(memo, *value);
+  }
+  co_return memo;
+}
+
+template<typename T, typename Function>
+task<void> each(async_generator<T> source, Function function) {
+  while (auto const* value = co_await source.next()) {
+    function(*value);
+  }
+}
+
+namespace helper {
+// A bounded single producer, single consumer queue between two coroutines.
+// Whichever side has to wait is suspended and later resumed on the pool, so
+// neither side ever blocks a thread or resumes the other under the lock.
+template<typename T>
+class Channel {
+ public:
+  Channel(ThreadPool& pool, std::size_t capacity)
+      : pool_(pool),
+        capacity_(capacity),
+        closed_(false),
+        producer_(nullptr),
+        consumer_(nullptr) {
+  }
+
+  class PushAwaiter {
+   public:
+    PushAwaiter(Channel& channel, T const& value)
+        : channel_(channel), value_(value), accepted_(false) {
+    }
+
+    bool await_ready() const noexcept {
+      return false;
+    }
+
+    bool await_suspend(std::coroutine_handle<> coroutine) {
+      coroutine_ = coroutine;
+      return channel_.push(*this);
+    }
+
+    // Whether the value was accepted; false once the channel is closed.
+    bool await_resume() const noexcept {
+      return accepted_;
+    }
+
+   private:
+    friend class Channel;
+
+    Channel& channel_;
+    T const& value_;
+    bool accepted_;
+    std::coroutine_handle<> coroutine_;
+  };
+
+  class PopAwaiter {
+   public:
+    explicit PopAwaiter(Channel& channel) : channel_(channel) {
+    }
+
+    bool await_ready() const noexcept {
+      return false;
+    }
+
+    bool await_suspend(std::coroutine_handle<> coroutine) {
+      coroutine_ = coroutine;
+      return channel_.pop(*this);
+    }
+
+    // Empty once the channel is closed and drained.
+    std::optional<T> await_resume() {
+      if (!value_) {
+        channel_.rethrow_if_failed();
+      }
+      return std::move(value_);
+    }
+
+   private:
+    friend class Channel;
+
+    Channel& channel_;
+    std::optional<T> value_;
+    std::coroutine_handle<> coroutine_;
+  };
+
+  PushAwaiter push(T const& value) {
+    return PushAwaiter(*this, value);
+  }
+
+  PopAwaiter pop() {
+    return PopAwaiter(*this);
+  }
+
+  void close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+    if (consumer_) {
+      pool_.post(std::exchange(consumer_, nullptr)->coroutine_);
+    }
+    if (producer_) {
+      pool_.post(std::exchange(producer_, nullptr)->coroutine_);
+    }
+  }
+
+  void fail(std::exception_ptr exception) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      exception_ = exception;
+    }
+    close();
+  }
+
+ private:
+  // Each of these returns whether the awaiting coroutine has to suspend.
+  bool push(PushAwaiter& pushing) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closed_) {
+      return false;
+    }
+    pushing.accepted_ = true;
+    if (consumer_) {
+      consumer_->value_.emplace(pushing.value_);
+      pool_.post(std::exchange(consumer_, nullptr)->coroutine_);
+      return false;
+    }
+    if (items_.size() < capacity_) {
+      items_.push_back(pushing.value_);
+      return false;
+    }
+    producer_ = &pushing;
+    return true;
+  }
+
+  bool pop(PopAwaiter& popping) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!items_.empty()) {
+      popping.value_.emplace(std::move(items_.front()));
+      items_.pop_front();
+      if (producer_) {
+        items_.push_back(producer_->value_);
+        pool_.post(std::exchange(producer_, nullptr)->coroutine_);
+      }
+      return false;
+    }
+    if (producer_) {
+      popping.value_.emplace(producer_->value_);
+      pool_.post(std::exchange(producer_, nullptr)->coroutine_);
+      return false;
+    }
+    if (closed_) {
+      return false;
+    }
+    consumer_ = &popping;
+    return true;
+  }
+
+  void rethrow_if_failed() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (exception_) {
+      std::rethrow_exception(exception_);
+    }
+  }
+
+  ThreadPool& pool_;
+  std::size_t capacity_;
+  std::mutex mutex_;
+  std::deque<T> items_;
+  bool closed_;
+  PushAwaiter* producer_;
+  PopAwaiter* consumer_;
+  std::exception_ptr exception_;
+};
+
+// A coroutine nobody waits for. It starts immediately and cleans up after
+// itself when it finishes.
+struct Detached {
+  struct promise_type {
+    Detached get_return_object() {
+      return Detached();
+    }
+
+    std::suspend_never initial_suspend() noexcept {
+      return {};
+    }
+
+    std::suspend_never final_suspend() noexcept {
+      return {};
+    }
+
+    void return_void() {
+    }
+
+    void unhandled_exception() {
+      std::terminate();
+    }
+  };
+};
+
+template<typename T>
+Detached pump(
+    async_generator<T> source,
+    std::shared_ptr<Channel<typename async_generator<T>::value_type> > channel,
+    ThreadPool& pool) {
+  co_await pool.schedule();
+  try {
+    while (auto const* value = co_await source.next()) {
+      if (!co_await channel->push(*value)) {
+        break;
+      }
+    }
+  } catch (...) {
+    channel->fail(std::current_exception());
+  }
+  channel->close();
+}
+
+template<typename T>
+struct ChannelCloser {
+  ~ChannelCloser() {
+    channel->close();
+  }
+
+  std::shared_ptr<Channel<T> > channel;
+};
+}  // namespace helper
+
+// buffer
+// Runs the source on the pool, up to `capacity` values ahead of the
+// consumer. Destroying the buffered generator early stops the source at its
+// next value.
+template<typename T>
+async_generator<T> buffer(
+    async_generator<T> source,
+    ThreadPool& pool,
+    std::size_t capacity) {
+  typedef typename async_generator<T>::value_type Value;
+  std::shared_ptr<helper::Channel<Value> > channel =
+      std::make_shared<helper::Channel<Value> >(pool, capacity);
+  helper::ChannelCloser<Value> closer = {channel};
+  helper::pump(std::move(source), channel, pool);
+  while (std::optional<Value> value = co_await channel->pop()) {
+    co_yield *value;
+  }
+}
+
+// Chaining an async generator moves it along the chain, like a generator.
+// each and reduce end the chain with the task that runs it.
+template<typename T>
+class Wrapper<async_generator<T> > {
+ public:
+  typedef async_generator<T> value_type;
+
+  explicit Wrapper(async_generator<T> source) : source_(std::move(source)) {
+  }
+
+  async_generator<T> value() {
+    return std::move(source_);
+  }
+
+  template<typename Function>
+  task<void> each(Function function) {
+    return underscore::each(std::move(source_), function);
+  }
+
+  template<typename Function>
+  auto map(Function function) {
+    auto mapped = underscore::map(std::move(source_), function);
+    return Wrapper<decltype(mapped)>(std::move(mapped));
+  }
+
+  template<typename Predicate>
+  Wrapper filter(Predicate predicate) {
+    return Wrapper(underscore::filter(std::move(source_), predicate));
+  }
+
+  Wrapper take(std::size_t count) {
+    return Wrapper(underscore::take(std::move(source_), count));
+  }
+
+  Wrapper buffer(ThreadPool& pool, std::size_t capacity) {
+    return Wrapper(underscore::buffer(std::move(source_), pool, capacity));
+  }
+
+  template<typename Function, typename Memo>
+  task<Memo> reduce(Function function, Memo memo) {
+    return underscore::reduce(std::move(source_), function, memo);
+  }
+
+ private:
+  async_generator<T> source_;
+};
+
+template<typename T>
+Wrapper<async_generator<T> > chain(async_generator<T> source) {
+  return Wrapper<async_generator<T> >(std::move(source));
+}
+
+}  // namespace underscore
+
+#endif  // UNDERSCORE_COROUTINE_H_
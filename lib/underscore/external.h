@@ -0,0 +1,409 @@
+#ifndef UNDERSCORE_EXTERNAL_H_
+#define UNDERSCORE_EXTERNAL_H_
+
+// Out-of-core versions of sort_by and group_by for inputs that don't fit in
+// memory. The input is cut into runs that fit in the given memory budget;
+// each run is sorted and spilled to an anonymous temporary file as raw
+// records, and the runs are then merged back with a loser tree. While one run
+// is being sorted and written in the background, the next one is being read,
+// so I/O overlaps with the computation. The results are handed to a sink in
+// order, so they never have to be materialized either. The sort is stable,
+// so equal elements, and the elements of a group, keep their input order.
+//
+// The element (and key) types have to be trivially copyable, since they are
+// written to disk byte for byte. The input can be any container, including
+// the file sources from underscore/stream.h. Failing to create or write a
+// temporary file throws std::runtime_error.
+//
+// This header requires C++11.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "helper.h"
+
+namespace underscore {
+
+namespace helper {
+struct TemporaryFileCloser {
+  void operator()(std::FILE* file) const {
+    std::fclose(file);
+  }
+};
+
+typedef std::unique_ptr<std::FILE, TemporaryFileCloser> TemporaryFile;
+
+// Reads a sorted run back a buffer at a time.
+template<typename T>
+class RunReader {
+ public:
+  RunReader(TemporaryFile file, std::size_t buffered)
+      : file_(std::move(file)), buffer_(buffered), index_(0), count_(0) {
+    std::rewind(file_.get());
+    next();
+  }
+
+  bool exhausted() const {
+    return index_ == count_;
+  }
+
+  T const& head() const {
+    return buffer_[index_];
+  }
+
+  void next() {
+    if (count_ && ++index_ < count_) {
+      return;
+    }
+    count_ = std::fread(&buffer_[0], sizeof(T), buffer_.size(), file_.get());
+    if (count_ < buffer_.size() && std::ferror(file_.get())) {
+      throw std::runtime_error("unable to read a temporary run file");
+    }
+    index_ = 0;
+  }
+
+ private:
+  TemporaryFile file_;
+  std::vector<T> buffer_;
+  std::size_t index_;
+  std::size_t count_;
+};
+
+// A tournament tree over the heads of k runs in which every internal node
+// remembers the loser of its match, so replacing the winner only replays the
+// log(k) matches on its path to the root. Exhausted runs always lose.
+template<typename T, typename Compare>
+class LoserTree {
+ public:
+  LoserTree(std::vector<RunReader<T> >& runs, Compare compare)
+      : runs_(runs), compare_(compare), losers_(runs.size()) {
+    std::size_t const k = runs_.size();
+    std::vector<std::size_t> winners(2 * k);
+    for (std::size_t i = 0; i < k; ++i) {
+      winners[k + i] = i;
+    }
+    for (std::size_t node = k - 1; node > 0; --node) {
+      std::size_t const left = winners[2 * node];
+      std::size_t const right = winners[2 * node + 1];
+      if (beats(left, right)) {
+        winners[node] = left;
+        losers_[node] = right;
+      } else {
+        winners[node] = right;
+        losers_[node] = left;
+      }
+    }
+    losers_[0] = k > 1 ? winners[1] : 0;
+  }
+
+  bool empty() const {
+    return runs_[losers_[0]].exhausted();
+  }
+
+  T const& top() const {
+    return runs_[losers_[0]].head();
+  }
+
+  void pop() {
+    std::size_t winner = losers_[0];
+    runs_[winner].next();
+    for (std::size_t node = (winner + runs_.size()) / 2; node > 0; node /= 2) {
+      if (beats(losers_[node], winner)) {
+        std::swap(losers_[node], winner);
+      }
+    }
+    losers_[0] = winner;
+  }
+
+ private:
+  // Ties go to the earlier run, which keeps the merge stable.
+  bool beats(std::size_t left, std::size_t right) const {
+    if (runs_[left].exhausted()) {
+      return false;
+    }
+    if (runs_[right].exhausted()) {
+      return true;
+    }
+    if (compare_(runs_[left].head(), runs_[right].head())) {
+      return true;
+    }
+    if (compare_(runs_[right].head(), runs_[left].head())) {
+      return false;
+    }
+    return left < right;
+  }
+
+  std::vector<RunReader<T> >& runs_;
+  Compare compare_;
+  std::vector<std::size_t> losers_;
+};
+
+template<typename T, typename Compare>
+class ExternalSorter {
+  static_assert(
+      std::is_trivially_copyable<T>::value,
+      "externally sorted values must be trivially copyable");
+
+ public:
+  // Half the budget holds the run being read and half the run being sorted.
+  // The run being sorted is freed as soon as it has been written, and merges
+  // only use the part of the budget that the run being read leaves free.
+  ExternalSorter(Compare compare, std::size_t memory_budget)
+      : compare_(compare),
+        memory_budget_(memory_budget),
+        run_capacity_(std::max<std::size_t>(
+            memory_budget / (2 * sizeof(T)),
+            1)) {
+    filling_.reserve(run_capacity_);
+  }
+
+  ~ExternalSorter() {
+    if (pending_.valid()) {
+      pending_.wait();
+    }
+  }
+
+  void add(T const& value) {
+    filling_.push_back(value);
+    if (filling_.size() == run_capacity_) {
+      spill();
+    }
+  }
+
+  template<typename Sink>
+  void finish(Sink sink) {
+    if (levels_.empty() && !pending_.valid()) {
+      std::stable_sort(filling_.begin(), filling_.end(), compare_);
+      for (typename std::vector<T>::const_iterator i = filling_.begin();
+          i != filling_.end();
+          ++i) {
+        sink(*i);
+      }
+      return;
+    }
+
+    if (!filling_.empty()) {
+      spill();
+    }
+    std::vector<T>().swap(filling_);
+    collect_pending();
+
+    // A level's runs were all spilled after those of the levels above it, so
+    // the runs are merged from the top level down to keep them in input order.
+    std::vector<TemporaryFile> runs;
+    for (std::size_t level = levels_.size(); level-- > 0;) {
+      for (std::size_t i = 0; i < levels_[level].size(); ++i) {
+        runs.push_back(std::move(levels_[level][i]));
+      }
+    }
+    levels_.clear();
+    merge(runs, memory_budget_, sink);
+  }
+
+ private:
+  // Runs are kept in levels. Once a level holds this many runs they are
+  // merged into a single run on the next level, which bounds the number of
+  // open temporary files when the budget is small compared to the input while
+  // reading every element only O(log n) times.
+  static std::size_t const kMaximumRuns = 64;
+
+  template<typename Sink>
+  void merge(
+      std::vector<TemporaryFile>& runs,
+      std::size_t memory_budget,
+      Sink sink) {
+    // Each run also costs a reader and three loser tree slots.
+    std::size_t const overhead =
+        runs.size() * (sizeof(RunReader<T>) + 3 * sizeof(std::size_t));
+    std::size_t const buffered = std::max<std::size_t>(
+        (memory_budget > overhead ? memory_budget - overhead : 0) /
+            (runs.size() * sizeof(T)),
+        1);
+    std::vector<RunReader<T> > readers;
+    readers.reserve(runs.size());
+    for (std::size_t i = 0; i < runs.size(); ++i) {
+      readers.push_back(RunReader<T>(std::move(runs[i]), buffered));
+    }
+    runs.clear();
+
+    for (LoserTree<T, Compare> tree(readers, compare_);
+        !tree.empty();
+        tree.pop()) {
+      sink(tree.top());
+    }
+  }
+
+  // Merges the runs of a level into a single run, within the memory that the
+  // run buffers leave free. Half of it is used for reading the runs and half
+  // for buffering the merged output.
+  TemporaryFile merge_level(std::size_t level) {
+    std::size_t const used =
+        (filling_.capacity() + sorting_.capacity()) * sizeof(T);
+    std::size_t const available =
+        memory_budget_ > used ? memory_budget_ - used : 0;
+    std::size_t const buffered = std::max<std::size_t>(
+        available / (2 * sizeof(T)),
+        1);
+    TemporaryFile merged = create_temporary_file();
+    std::vector<T> buffer;
+    buffer.reserve(buffered);
+    merge(levels_[level], available / 2, [&](T const& value) {
+      buffer.push_back(value);
+      if (buffer.size() == buffered) {
+        write(merged, buffer);
+        buffer.clear();
+      }
+    });
+    write(merged, buffer);
+    return merged;
+  }
+
+  static TemporaryFile create_temporary_file() {
+    TemporaryFile file(std::tmpfile());
+    if (!file) {
+      throw std::runtime_error("unable to create a temporary run file");
+    }
+    return file;
+  }
+
+  static void write(TemporaryFile const& file, std::vector<T> const& values) {
+    if (values.empty()) {
+      return;
+    }
+    if (std::fwrite(&values[0], sizeof(T), values.size(), file.get()) !=
+        values.size()) {
+      throw std::runtime_error("unable to write a temporary run file");
+    }
+  }
+
+  void spill() {
+    collect_pending();
+    filling_.swap(sorting_);
+    filling_.clear();
+    filling_.reserve(run_capacity_);
+    pending_ = std::async(std::launch::async, [this]() {
+      std::stable_sort(sorting_.begin(), sorting_.end(), compare_);
+      TemporaryFile file = create_temporary_file();
+      write(file, sorting_);
+      std::vector<T>().swap(sorting_);
+      return file;
+    });
+  }
+
+  void collect_pending() {
+    if (pending_.valid()) {
+      if (levels_.empty()) {
+        levels_.resize(1);
+      }
+      levels_[0].push_back(pending_.get());
+      for (std::size_t level = 0;
+          levels_[level].size() == kMaximumRuns;
+          ++level) {
+        TemporaryFile merged = merge_level(level);
+        if (level + 1 == levels_.size()) {
+          levels_.resize(level + 2);
+        }
+        levels_[level + 1].push_back(std::move(merged));
+      }
+    }
+  }
+
+  Compare compare_;
+  std::size_t memory_budget_;
+  std::size_t run_capacity_;
+  std::vector<T> filling_;
+  std::vector<T> sorting_;
+  std::vector<std::vector<TemporaryFile> > levels_;
+  std::future<TemporaryFile> pending_;
+};
+
+template<typename T, typename Compare>
+std::size_t const ExternalSorter<T, Compare>::kMaximumRuns;
+
+template<typename Key, typename T>
+struct KeyedValue {
+  Key key;
+  T value;
+};
+
+template<typename Key, typename T>
+struct KeyedValueLess {
+  bool operator()(
+      KeyedValue<Key, T> const& left,
+      KeyedValue<Key, T> const& right) const {
+    return left.key < right.key;
+  }
+};
+}  // namespace helper
+
+// external_sort_by
+// Like sort_by, the function is the comparison. Every element is passed to
+// `sink(element)` in sorted order. The budget is in bytes.
+template<typename Container, typename Function, typename Sink>
+void external_sort_by(
+    Container const& container,
+    Function function,
+    Sink sink,
+    std::size_t memory_budget) {
+  helper::ExternalSorter<typename Container::value_type, Function> sorter(
+      function,
+      memory_budget);
+  for (typename Container::const_iterator i = container.begin();
+      i != container.end();
+      ++i) {
+    sorter.add(*i);
+  }
+  sorter.finish(sink);
+}
+
+template<typename Container, typename OutputIterator, typename Function>
+OutputIterator external_sort_by_to(
+    Container const& container,
+    OutputIterator output,
+    Function function,
+    std::size_t memory_budget) {
+  external_sort_by(
+      container,
+      function,
+      [&output](typename Container::value_type const& value) {
+        *output++ = value;
+      },
+      memory_budget);
+  return output;
+}
+
+// external_group_by
+// Like group_by, but instead of building a multimap, every element is passed
+// to `sink(key, element)` ordered by key, so each group arrives as a run of
+// consecutive calls with an equal key. The budget is in bytes.
+template<typename Key, typename Container, typename Function, typename Sink>
+void external_group_by(
+    Container const& container,
+    Function function,
+    Sink sink,
+    std::size_t memory_budget) {
+  typedef typename Container::value_type Value;
+  typedef helper::KeyedValue<Key, Value> Record;
+  helper::ExternalSorter<Record, helper::KeyedValueLess<Key, Value> > sorter(
+      helper::KeyedValueLess<Key, Value>(),
+      memory_budget);
+  for (typename Container::const_iterator i = container.begin();
+      i != container.end();
+      ++i) {
+    Record const record = {function(*i), *i};
+    sorter.add(record);
+  }
+  sorter.finish([&sink](Record const& record) {
+    sink(record.key, record.value);
+  });
+}
+
+}  // namespace underscore
+
+#endif  // UNDERSCORE_EXTERNAL_H_
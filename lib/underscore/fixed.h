@@ -0,0 +1,456 @@
+#ifndef UNDERSCORE_FIXED_H_
+#define UNDERSCORE_FIXED_H_
+
+// constexpr versions of map, filter, reduce, range, sort_by, uniq, zip and
+// index_of over fixed-size containers, so that lookup and dispatch tables can
+// be computed while compiling instead of during static initialization, e.g.
+//
+//   constexpr auto squares = _::fixed::map<std::array<int, 16> >(
+//       _::fixed::range<std::array<int, 16> >(16), square);
+//   static_assert(squares[3] == 9, "");
+//
+// The inputs are std::arrays or StaticVectors (below), and so are the
+// results, which are given explicitly as with the rest of Underscore.
+// StaticVector results hold exactly the elements produced. std::array
+// results are filled from the front and the remaining elements keep their
+// value-initialized values. Producing more elements than a result can hold
+// throws std::length_error, which is a compile error in a constant
+// expression.
+//
+// The element types have to be literal types with a default constructor.
+// Before C++20, std::pair can't be assigned in a constant expression, so
+// zipping into a StaticVector and sorting containers of pairs only produce
+// constants from C++20 on. Zipping into a std::array works in C++17.
+//
+// This header requires C++17.
+
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <stdexcept>
+#include <utility>
+
+#include "helper.h"
+
+namespace underscore {
+namespace fixed {
+
+// StaticVector
+// A vector with its capacity fixed at compile time and its elements stored
+// inline. It has push_back, so it can also be used as the result container
+// of the other Underscore functions at run time.
+template<typename T, std::size_t Capacity>
+class StaticVector {
+ public:
+  typedef T value_type;
+  typedef std::size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+  typedef T& reference;
+  typedef T const& const_reference;
+  typedef T* pointer;
+  typedef T const* const_pointer;
+  typedef T* iterator;
+  typedef T const* const_iterator;
+
+  constexpr StaticVector() : data_(), size_(0) {
+  }
+
+  constexpr StaticVector(std::initializer_list<T> values)
+      : data_(), size_(0) {
+    for (T const& value : values) {
+      push_back(value);
+    }
+  }
+
+  constexpr void push_back(T const& value) {
+    if (size_ == Capacity) {
+      throw std::length_error("StaticVector capacity exceeded");
+    }
+    data_[size_++] = value;
+  }
+
+  constexpr void pop_back() {
+    --size_;
+  }
+
+  constexpr void clear() {
+    size_ = 0;
+  }
+
+  constexpr std::size_t size() const {
+    return size_;
+  }
+
+  static constexpr std::size_t capacity() {
+    return Capacity;
+  }
+
+  static constexpr std::size_t max_size() {
+    return Capacity;
+  }
+
+  constexpr bool empty() const {
+    return size_ == 0;
+  }
+
+  constexpr T& operator[](std::size_t index) {
+    return data_[index];
+  }
+
+  constexpr T const& operator[](std::size_t index) const {
+    return data_[index];
+  }
+
+  constexpr T& front() {
+    return data_[0];
+  }
+
+  constexpr T const& front() const {
+    return data_[0];
+  }
+
+  constexpr T& back() {
+    return data_[size_ - 1];
+  }
+
+  constexpr T const& back() const {
+    return data_[size_ - 1];
+  }
+
+  constexpr T* data() {
+    return data_;
+  }
+
+  constexpr T const* data() const {
+    return data_;
+  }
+
+  constexpr iterator begin() {
+    return data_;
+  }
+
+  constexpr const_iterator begin() const {
+    return data_;
+  }
+
+  constexpr iterator end() {
+    return data_ + size_;
+  }
+
+  constexpr const_iterator end() const {
+    return data_ + size_;
+  }
+
+  friend constexpr bool operator==(
+      StaticVector const& left,
+      StaticVector const& right) {
+    if (left.size_ != right.size_) {
+      return false;
+    }
+    for (std::size_t i = 0; i < left.size_; ++i) {
+      if (!(left.data_[i] == right.data_[i])) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  friend constexpr bool operator!=(
+      StaticVector const& left,
+      StaticVector const& right) {
+    return !(left == right);
+  }
+
+ private:
+  T data_[Capacity == 0 ? 1 : Capacity];
+  std::size_t size_;
+};
+
+}  // namespace fixed
+
+namespace helper {
+// Adds the `count`th element to a fixed result container.
+template<typename T, std::size_t Capacity, typename Value>
+constexpr void fixed_append(
+    fixed::StaticVector<T, Capacity>& result,
+    std::size_t,
+    Value const& value) {
+  result.push_back(T(value));
+}
+
+template<typename T, std::size_t Size, typename Value>
+constexpr void fixed_append(
+    std::array<T, Size>& result,
+    std::size_t count,
+    Value const& value) {
+  if (count >= Size) {
+    throw std::length_error("std::array result is too small");
+  }
+  result[count] = T(value);
+}
+
+template<typename T>
+struct FixedIdentity {
+  constexpr T const& operator()(T const& value) const {
+    return value;
+  }
+};
+
+// std::arrays of pairs are built in a single aggregate initialization, since
+// assigning a std::pair isn't a constant expression before C++20.
+template<typename ResultContainer,
+    typename Container1,
+    typename Container2,
+    std::size_t... Indices>
+constexpr ResultContainer fixed_zip_array(
+    Container1 const& container1,
+    Container2 const& container2,
+    std::size_t count,
+    std::index_sequence<Indices...>) {
+  typedef typename ResultContainer::value_type Value;
+  return ResultContainer{{
+      (Indices < count ?
+          Value(container1[Indices], container2[Indices]) :
+          Value())...}};
+}
+
+template<typename ResultContainer, typename Container1, typename Container2>
+struct FixedZip {
+  static constexpr ResultContainer apply(
+      Container1 const& container1,
+      Container2 const& container2,
+      std::size_t count) {
+    ResultContainer result;
+    for (std::size_t i = 0; i < count; ++i) {
+      fixed_append(
+          result,
+          i,
+          typename ResultContainer::value_type(
+              container1[i],
+              container2[i]));
+    }
+    return result;
+  }
+};
+
+template<typename T,
+    std::size_t Size,
+    typename Container1,
+    typename Container2>
+struct FixedZip<std::array<T, Size>, Container1, Container2> {
+  static constexpr std::array<T, Size> apply(
+      Container1 const& container1,
+      Container2 const& container2,
+      std::size_t count) {
+    if (count > Size) {
+      throw std::length_error("std::array result is too small");
+    }
+    return fixed_zip_array<std::array<T, Size> >(
+        container1,
+        container2,
+        count,
+        std::make_index_sequence<Size>());
+  }
+};
+}  // namespace helper
+
+namespace fixed {
+
+// map/collect
+template<typename ResultContainer, typename Container, typename Function>
+constexpr ResultContainer map(Container const& container, Function function) {
+  ResultContainer result{};
+  for (std::size_t i = 0; i < container.size(); ++i) {
+    helper::fixed_append(result, i, function(container[i]));
+  }
+  return result;
+}
+
+// filter/select
+template<typename ResultContainer, typename Container, typename Predicate>
+constexpr ResultContainer filter(
+    Container const& container,
+    Predicate predicate) {
+  ResultContainer result{};
+  std::size_t count = 0;
+  for (std::size_t i = 0; i < container.size(); ++i) {
+    if (predicate(container[i])) {
+      helper::fixed_append(result, count++, container[i]);
+    }
+  }
+  return result;
+}
+
+// reduce/inject/foldl
+template<typename Container, typename Function, typename Memo>
+constexpr Memo reduce(
+    Container const& container,
+    Function function,
+    Memo memo) {
+  for (std::size_t i = 0; i < container.size(); ++i) {
+    memo = function(memo, container[i]);
+  }
+  return memo;
+}
+
+// range
+template<typename ResultContainer>
+constexpr ResultContainer range(int start, int stop, int step) {
+  int const length = (stop - start) / step > 0 ? (stop - start) / step : 0;
+  ResultContainer result{};
+  for (int index = 0; index < length; ++index) {
+    helper::fixed_append(result, index, start);
+    start += step;
+  }
+  return result;
+}
+
+template<typename ResultContainer>
+constexpr ResultContainer range(int start, int stop) {
+  return range<ResultContainer>(start, stop, 1);
+}
+
+template<typename ResultContainer>
+constexpr ResultContainer range(int stop) {
+  return range<ResultContainer>(0, stop, 1);
+}
+
+// sort_by
+// A bottom-up merge sort, so it is stable and O(n log n) even at compile
+// time, where the evaluation step limit makes a quadratic sort impractical for
+// tables of a few thousand entries.
+template<typename Container, typename Function>
+constexpr Container sort_by(Container const& container, Function function) {
+  Container first = container;
+  Container second = container;
+  Container* from = &first;
+  Container* to = &second;
+  std::size_t const size = container.size();
+  for (std::size_t width = 1; width < size; width *= 2) {
+    for (std::size_t low = 0; low < size; low += 2 * width) {
+      std::size_t const middle = low + width < size ? low + width : size;
+      std::size_t const high =
+          low + 2 * width < size ? low + 2 * width : size;
+      std::size_t left = low;
+      std::size_t right = middle;
+      for (std::size_t out = low; out < high; ++out) {
+        if (left < middle &&
+            (right == high || !function((*from)[right], (*from)[left]))) {
+          (*to)[out] = (*from)[left++];
+        } else {
+          (*to)[out] = (*from)[right++];
+        }
+      }
+    }
+    Container* const swapped = from;
+    from = to;
+    to = swapped;
+  }
+  return *from;
+}
+
+// uniq/unique
+// Keeps the first element with each key. Sorted input only needs to be
+// compared with the last element kept; otherwise every kept element is
+// searched, as uniq does.
+template<typename ResultContainer,
+    typename Key,
+    typename Container,
+    typename Function>
+constexpr ResultContainer uniq(
+    Container const& container,
+    bool is_sorted,
+    Function function) {
+  ResultContainer result{};
+  std::size_t count = 0;
+  for (std::size_t i = 0; i < container.size(); ++i) {
+    Key const key = function(container[i]);
+    bool seen = false;
+    for (std::size_t j = is_sorted && count ? count - 1 : 0;
+        j < count && !seen;
+        ++j) {
+      seen = Key(function(result[j])) == key;
+    }
+    if (!seen) {
+      helper::fixed_append(result, count++, container[i]);
+    }
+  }
+  return result;
+}
+
+template<typename ResultContainer,
+    typename Key,
+    typename Container,
+    typename Function>
+constexpr ResultContainer uniq(Container const& container, Function function) {
+  return uniq<ResultContainer, Key>(container, false, function);
+}
+
+template<typename ResultContainer, typename Container>
+constexpr ResultContainer uniq(Container const& container, bool is_sorted) {
+  return uniq<ResultContainer, typename Container::value_type>(
+      container,
+      is_sorted,
+      helper::FixedIdentity<typename Container::value_type>());
+}
+
+template<typename ResultContainer, typename Container>
+constexpr ResultContainer uniq(Container const& container) {
+  return uniq<ResultContainer>(container, false);
+}
+
+// zip
+// Pairs up elements until the shorter container runs out.
+template<typename ResultContainer, typename Container1, typename Container2>
+constexpr ResultContainer zip(
+    Container1 const& container1,
+    Container2 const& container2) {
+  std::size_t const count = container1.size() < container2.size() ?
+      container1.size() :
+      container2.size();
+  return helper::FixedZip<ResultContainer, Container1, Container2>::apply(
+      container1,
+      container2,
+      count);
+}
+
+// index_of
+template<typename Container>
+constexpr int index_of(
+    Container const& container,
+    typename Container::value_type const& value) {
+  for (std::size_t i = 0; i < container.size(); ++i) {
+    if (container[i] == value) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+template<typename Container>
+constexpr int index_of(
+    Container const& container,
+    typename Container::value_type const& value,
+    bool is_sorted) {
+  if (!is_sorted) {
+    return index_of(container, value);
+  }
+  std::size_t low = 0;
+  std::size_t high = container.size();
+  while (low < high) {
+    std::size_t const middle = low + (high - low) / 2;
+    if (container[middle] < value) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return low < container.size() && !(value < container[low]) ?
+      static_cast<int>(low) :
+      -1;
+}
+
+}  // namespace fixed
+}  // namespace underscore
+
+#endif  // UNDERSCORE_FIXED_H_
@@ -0,0 +1,25 @@
+#ifndef UNDERSCORE_FUNCTIONS_H_
+#define UNDERSCORE_FUNCTIONS_H_
+
+// Functions: none of the Underscore.js function helpers are implemented
+// yet.
+
+#include "helper.h"
+
+namespace underscore {
+
+// bind
+// bindAll
+// memoize
+// delay
+// defer
+// throttle
+// debounce
+// once
+// after
+// wrap
+// compose
+
+}  // namespace underscore
+
+#endif  // UNDERSCORE_FUNCTIONS_H_
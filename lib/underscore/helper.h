@@ -0,0 +1,308 @@
+#ifndef UNDERSCORE_HELPER_H_
+#define UNDERSCORE_HELPER_H_
+
+// The pieces every section of Underscore builds on: choosing how to add an
+// element to a result container, the instrumentation hooks and allocator
+// rebinding. The threads behind the parallel variants are in parallel.h.
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Defining UNDERSCORE_INSTRUMENT before including this header makes the
+// functions report their element counts, timings, allocations and copies to
+// the sink set with underscore::instrument::set_sink (see
+// underscore/instrument.h, which needs C++11). Otherwise the hooks below
+// expand to nothing.
+#ifdef UNDERSCORE_INSTRUMENT
+#include "instrument.h"
+#define UNDERSCORE_PROFILE(name, container)                                 \
+  ::underscore::instrument::Scope const underscore_profile_scope_(          \
+      name, ::underscore::instrument::element_count(container))
+#define UNDERSCORE_PROFILE_PAIR(name, container1, container2)               \
+  ::underscore::instrument::Scope const underscore_profile_scope_(          \
+      name,                                                                 \
+      ::underscore::instrument::pair_element_count(container1, container2))
+#define UNDERSCORE_PROFILE_COUNT(name, count)                               \
+  ::underscore::instrument::Scope const underscore_profile_scope_(          \
+      name, static_cast<std::size_t>(count))
+#define UNDERSCORE_PROFILE_STAGE(name, container)                           \
+  ::underscore::instrument::Scope const underscore_profile_scope_(          \
+      name, ::underscore::instrument::element_count(container), true)
+#define UNDERSCORE_COUNT_ADDITION(container)                                \
+  ::underscore::instrument::count_addition(container)
+#define UNDERSCORE_COUNT_SCRATCH(vector)                                    \
+  ::underscore::instrument::count_scratch(vector)
+#define UNDERSCORE_COUNT_RESULT(container)                                  \
+  ::underscore::instrument::count_result(container)
+#else
+#define UNDERSCORE_PROFILE(name, container)
+#define UNDERSCORE_PROFILE_PAIR(name, container1, container2)
+#define UNDERSCORE_PROFILE_COUNT(name, count)
+#define UNDERSCORE_PROFILE_STAGE(name, container)
+#define UNDERSCORE_COUNT_ADDITION(container)
+#define UNDERSCORE_COUNT_SCRATCH(vector)
+#define UNDERSCORE_COUNT_RESULT(container)
+#endif
+
+namespace underscore {
+
+namespace helper {
+
+// For a number of Underscore functions, the elements of a container are
+// transformed in some way, and the results are placed in another container.
+// To be able to support different kinds of containers, a way of choosing the
+// proper method for addition to the result container must be called, but these
+// methods are not uniform across the standard library.
+
+// To get around this, the correct function to call must be determined at
+// compile time. With C++20 concepts, add_to_container is a single constrained
+// template and each concept is checked once per container type. C++11 and
+// C++14 detect the same calls with expression SFINAE. Both accept any
+// `push_back(value)` or `insert(value)` call that compiles, whatever its exact
+// signature, so e.g. std::multiset, std::basic_string and std::vector<bool>
+// work as result containers.
+//
+// C++98 can only match member functions by exact signature, so there the
+// supported signatures are `void push_back(value_type const&)` and
+// `std::pair<iterator, bool> insert(value_type const&)`.
+#if defined(__cpp_concepts) && __cpp_concepts >= 201907L
+#define UNDERSCORE_CONCEPTS 1
+#endif
+
+#if defined(UNDERSCORE_CONCEPTS)
+template<typename Container>
+concept BackInsertable = requires(
+    Container& container,
+    typename Container::value_type const& value) {
+  container.push_back(value);
+};
+
+template<typename Container>
+concept Insertable = requires(
+    Container& container,
+    typename Container::value_type const& value) {
+  container.insert(value);
+};
+
+template<typename Container>
+struct MemberAdditionCapabilities {
+  static bool const has_push_back = BackInsertable<Container>;
+  static bool const has_insert = Insertable<Container>;
+};
+#elif __cplusplus >= 201103L
+template<typename T>
+struct Void {
+  typedef void type;
+};
+
+template<typename Container, typename = void>
+struct HasPushBack {
+  static bool const value = false;
+};
+
+template<typename Container>
+struct HasPushBack<Container, typename Void<decltype(
+    std::declval<Container&>().push_back(
+        std::declval<typename Container::value_type const&>()))>::type> {
+  static bool const value = true;
+};
+
+template<typename Container, typename = void>
+struct HasInsert {
+  static bool const value = false;
+};
+
+template<typename Container>
+struct HasInsert<Container, typename Void<decltype(
+    std::declval<Container&>().insert(
+        std::declval<typename Container::value_type const&>()))>::type> {
+  static bool const value = true;
+};
+
+template<typename Container>
+struct MemberAdditionCapabilities {
+  static bool const has_push_back = HasPushBack<Container>::value;
+  static bool const has_insert = HasInsert<Container>::value;
+};
+#else
+// Because the body to determine whether or not a given member function is
+// relatively large, the HAS_MEMBER_FUNCTION macro is temporarily defined to
+// help reduce code size.
+// This is from http://stackoverflow.com/a/264088/1256
+#define HAS_MEMBER_FUNCTION(func, name)                             \
+  template<typename T, typename Sign>                               \
+  struct name {                                                     \
+    typedef char yes[1];                                            \
+    typedef char no [2];                                            \
+    template <typename U, U> struct type_check;                     \
+    template <typename _1> static yes &chk(type_check<Sign, &_1::func> *); \
+    template <typename   > static no  &chk(...);                    \
+    static bool const value = sizeof(chk<T>(0)) == sizeof(yes);     \
+  }
+
+// Use the macro to define metafunctions for the various insertion methods that
+// Underscore supports. Primarily, these will be single parameter member
+// functions that are used across multiple types in the standard library.
+HAS_MEMBER_FUNCTION(push_back, HasPushBack);
+HAS_MEMBER_FUNCTION(insert, HasInsert);
+
+// Remove the macro so that it doesn't pollute the global scope.
+#undef HAS_MEMBER_FUNCTION
+
+// To simplify function declarations later, the insertion capabilities for a
+// given type are simply listed in a struct.
+template<typename Container>
+struct MemberAdditionCapabilities {
+  static bool const has_push_back = HasPushBack<
+    Container,
+    void (Container::*)(const typename Container::value_type&)>::value;
+  static bool const has_insert = HasInsert<
+    Container,
+    std::pair<
+      typename Container::iterator,
+      bool> (Container::*)(const typename Container::value_type&)>::value;
+};
+#endif
+
+template<typename Container>
+struct HasSupportedAdditionMethod {
+  static bool const value =
+      MemberAdditionCapabilities<Container>::has_push_back ||
+      MemberAdditionCapabilities<Container>::has_insert;
+};
+
+// Sets and maps, ordered or not, are the containers whose elements can't be
+// reassigned in place, so the in-place functions erase from them one node at
+// a time. They are recognized by their key_type rather than by a missing
+// push_back, which C++98 can't see on std::basic_string or std::vector<bool>.
+template<typename Container>
+struct IsAssociative {
+  typedef char yes[1];
+  typedef char no[2];
+  template<typename U> static yes& check(typename U::key_type*);
+  template<typename U> static no& check(...);
+  static bool const value = sizeof(check<Container>(0)) == sizeof(yes);
+};
+
+// A simple implementation of enable_if allows alternative functions to be
+// selected at compile time.
+// This is from http://stackoverflow.com/a/264088/1256
+template<bool C, typename T = void>
+struct enable_if {
+  typedef T type;
+};
+
+template<typename T>
+struct enable_if<false, T> {
+};
+
+#if defined(UNDERSCORE_CONCEPTS)
+template<typename Container>
+  requires BackInsertable<Container> || Insertable<Container>
+void add_to_container(
+    Container& container,
+    typename Container::value_type const & value) {
+  UNDERSCORE_COUNT_ADDITION(container);
+  if constexpr (BackInsertable<Container>) {
+    container.push_back(value);
+  } else {
+    container.insert(value);
+  }
+}
+#else
+template<typename Container>
+typename enable_if<
+  MemberAdditionCapabilities<Container>::has_insert,
+  void>::type insert(
+    Container& container,
+    typename Container::value_type const & value) {
+  container.insert(value);
+}
+
+template<typename Container>
+typename enable_if<
+  MemberAdditionCapabilities<Container>::has_push_back,
+  void>::type push_back(
+    Container& container,
+    typename Container::value_type const & value) {
+  container.push_back(value);
+}
+
+template<typename Container>
+typename enable_if<
+  !MemberAdditionCapabilities<Container>::has_push_back,
+  void>::type push_back(
+    Container& container,
+    typename Container::value_type const & value) {
+    insert(container, value);
+}
+
+template<typename Container>
+typename enable_if<
+  HasSupportedAdditionMethod<Container>::value,
+  void>::type add_to_container(
+    Container& container,
+    typename Container::value_type const & value) {
+  UNDERSCORE_COUNT_ADDITION(container);
+  push_back(container, value);
+}
+#endif
+
+template<typename T>
+struct is_void {
+  static bool const value = false;
+};
+
+template<>
+struct is_void<void> {
+  static bool const value = true;
+};
+
+template<typename T>
+struct Identity {
+  T const& operator()(T const& value) const {
+    return value;
+  }
+};
+
+// The allocator-aware overloads construct their results from the allocator
+// they are given, and rebind it for any scratch buffers they need, so that a
+// whole call can be kept off the global heap. Before C++11, only sequence
+// containers can be constructed from just an allocator. The allocator always
+// comes after every optional argument, so a function whose optional argument
+// is left out, e.g. the one argument rest or a scan without a projection, has
+// no allocator overload and the argument has to be given explicitly; for
+// scans, _::identity projects nothing.
+template<typename Allocator, typename T>
+struct Rebind {
+#if __cplusplus >= 201103L
+  typedef typename std::allocator_traits<Allocator>::template rebind_alloc<T>
+      type;
+#else
+  typedef typename Allocator::template rebind<T>::other type;
+#endif
+};
+
+template<typename T, typename Allocator>
+struct ScratchVector {
+  typedef std::vector<T, typename Rebind<Allocator, T>::type> type;
+};
+
+template<typename Container, typename Iterator>
+void append_range(Container& container, Iterator first, Iterator last) {
+  for (; first != last; ++first) {
+    add_to_container(container, *first);
+  }
+}
+
+}  // namespace helper
+
+}  // namespace underscore
+
+namespace _ = underscore;
+
+#endif  // UNDERSCORE_HELPER_H_
@@ -0,0 +1,365 @@
+#ifndef UNDERSCORE_INSTRUMENT_H_
+#define UNDERSCORE_INSTRUMENT_H_
+
+// Per-call metrics for the Underscore functions. Instrumentation is compiled
+// in only when UNDERSCORE_INSTRUMENT is defined before underscore.h is
+// included; otherwise the UNDERSCORE_PROFILE and UNDERSCORE_COUNT macros in
+// underscore/helper.h expand to nothing and this header isn't used at all.
+//
+// Every instrumented call reports a Record to the sink installed with set_sink,
+// with the number of input elements (or kUnknownElements when the input has no
+// size() and counting it would mean walking it), the wall time, and how many
+// allocations and element copies were made adding to the result container and
+// filling internal scratch buffers. Underscore calls made from inside another
+// instrumented call (uniq calling map and include, or a predicate that itself
+// calls an Underscore function) are attributed to the outer call, except that
+// each stage of a chain reports the call it wraps as well. Allocations are
+// counted as every node of a node-based container and every reallocation of a
+// vector, not by hooking the allocator: elements added one at a time are
+// counted as they are added, and a scratch vector or result built from a
+// range in one go counts as a single allocation.
+//
+// Two sinks are provided: CounterRegistry, which totals the records per
+// function, and ChromeTraceWriter, which writes them as complete events in
+// the Chrome trace event format, for chrome://tracing or Perfetto.
+//
+//   std::ofstream file("underscore.json");
+//   _::instrument::ChromeTraceWriter trace(file);
+//   _::instrument::set_sink(&trace);
+//
+// The sink must be safe to call from every thread that calls Underscore
+// functions; both of the provided ones are.
+//
+// This header requires C++11.
+
+#if __cplusplus < 201103L
+#error "UNDERSCORE_INSTRUMENT requires C++11"
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+namespace underscore {
+namespace instrument {
+
+// The element count of an input whose size isn't known in O(1).
+std::size_t const kUnknownElements = static_cast<std::size_t>(-1);
+
+struct Record {
+  char const* name;
+  // kUnknownElements if any of the inputs has no size().
+  std::size_t elements;
+  std::size_t allocations;
+  std::size_t copies;
+  // Nanoseconds on the steady clock.
+  unsigned long long start;
+  unsigned long long duration;
+  // 0 for a top level call or chain stage, 1 for the call inside a stage.
+  unsigned depth;
+  unsigned thread;
+};
+
+class Sink {
+ public:
+  virtual ~Sink() {
+  }
+
+  virtual void record(Record const& record) = 0;
+};
+
+inline std::atomic<Sink*>& current_sink() {
+  static std::atomic<Sink*> sink(nullptr);
+  return sink;
+}
+
+// Passing null stops reporting. The previous sink may still be receiving a
+// record from another thread when this returns.
+inline void set_sink(Sink* sink) {
+  current_sink().store(sink, std::memory_order_release);
+}
+
+class Scope {
+ public:
+  Scope(char const* name, std::size_t elements, bool is_stage = false)
+      : parent_(current()),
+        active_(!parent_ || parent_->is_stage_),
+        is_stage_(is_stage),
+        name_(name),
+        elements_(elements),
+        allocations_(0),
+        copies_(0),
+        start_(0) {
+    if (active_) {
+      current() = this;
+      start_ = now();
+    }
+  }
+
+  ~Scope() {
+    if (!active_) {
+      return;
+    }
+    unsigned long long const end = now();
+    current() = parent_;
+    if (parent_) {
+      parent_->allocations_ += allocations_;
+      parent_->copies_ += copies_;
+    }
+    Sink* sink = current_sink().load(std::memory_order_acquire);
+    if (sink) {
+      Record const record = {
+        name_,
+        elements_,
+        allocations_,
+        copies_,
+        start_,
+        end - start_,
+        parent_ ? 1u : 0u,
+        thread_number()
+      };
+      sink->record(record);
+    }
+  }
+
+  Scope(Scope const&) = delete;
+  Scope& operator=(Scope const&) = delete;
+
+  // Charges the innermost reporting scope on this thread, if any.
+  static void count(std::size_t allocations, std::size_t copies) {
+    Scope* scope = current();
+    if (scope) {
+      scope->allocations_ += allocations;
+      scope->copies_ += copies;
+    }
+  }
+
+ private:
+  static Scope*& current() {
+    static thread_local Scope* scope = nullptr;
+    return scope;
+  }
+
+  // Small sequential numbers, which trace viewers display better than hashed
+  // thread ids.
+  static unsigned thread_number() {
+    static std::atomic<unsigned> next(1);
+    static thread_local unsigned const number = next++;
+    return number;
+  }
+
+  static unsigned long long now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  Scope* parent_;
+  bool active_;
+  bool is_stage_;
+  char const* name_;
+  std::size_t elements_;
+  std::size_t allocations_;
+  std::size_t copies_;
+  unsigned long long start_;
+};
+
+// element_count
+// The size of the input where it has a size(), and kUnknownElements
+// otherwise, e.g. for a std::forward_list or a single pass source. Counting
+// those would take a walk over the input on every call, which is what the
+// call being measured costs in the first place.
+template<typename Container>
+auto element_count(Container const& container, int)
+    -> decltype(static_cast<std::size_t>(container.size())) {
+  return static_cast<std::size_t>(container.size());
+}
+
+template<typename Container>
+std::size_t element_count(Container const&, long) {
+  return kUnknownElements;
+}
+
+template<typename Container>
+std::size_t element_count(Container const& container) {
+  return element_count(container, 0);
+}
+
+template<typename Container1, typename Container2>
+std::size_t pair_element_count(
+    Container1 const& container1,
+    Container2 const& container2) {
+  std::size_t const count1 = element_count(container1);
+  std::size_t const count2 = element_count(container2);
+  if (count1 == kUnknownElements || count2 == kUnknownElements) {
+    return kUnknownElements;
+  }
+  return count1 + count2;
+}
+
+// Adding to a container with a capacity allocates only when it is full;
+// adding to any other container allocates a node.
+template<typename Container>
+auto allocates_on_addition(Container const& container, int)
+    -> decltype(container.capacity() == container.size()) {
+  return container.capacity() == container.size();
+}
+
+template<typename Container>
+bool allocates_on_addition(Container const&, long) {
+  return true;
+}
+
+template<typename Container>
+void count_addition(Container const& container) {
+  Scope::count(allocates_on_addition(container, 0) ? 1 : 0, 1);
+}
+
+// Called once a scratch vector has been filled. The vector must have been
+// constructed from a range or reserved up front, so that filling it
+// allocated at most once.
+template<typename Vector>
+void count_scratch(Vector const& vector) {
+  Scope::count(vector.capacity() ? 1 : 0, vector.size());
+}
+
+// A container with a capacity built from a range allocates once; any other
+// container allocates a node per element.
+template<typename Container>
+auto result_allocations(Container const& container, int)
+    -> decltype(container.capacity()) {
+  return container.capacity() ? 1 : 0;
+}
+
+template<typename Container>
+std::size_t result_allocations(Container const& container, long) {
+  return container.size();
+}
+
+// Called once a result container has been built from a range.
+template<typename Container>
+void count_result(Container const& container) {
+  Scope::count(result_allocations(container, 0), container.size());
+}
+
+// CounterRegistry
+// Running totals for each function name.
+class CounterRegistry : public Sink {
+ public:
+  struct Counters {
+    Counters()
+        : calls(0),
+          uncounted_calls(0),
+          elements(0),
+          allocations(0),
+          copies(0),
+          nanoseconds(0) {
+    }
+
+    unsigned long long calls;
+    // Calls whose element count was unknown, which elements leaves out.
+    unsigned long long uncounted_calls;
+    unsigned long long elements;
+    unsigned long long allocations;
+    unsigned long long copies;
+    unsigned long long nanoseconds;
+  };
+
+  void record(Record const& record) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Counters& counters = counters_[record.name];
+    ++counters.calls;
+    if (record.elements == kUnknownElements) {
+      ++counters.uncounted_calls;
+    } else {
+      counters.elements += record.elements;
+    }
+    counters.allocations += record.allocations;
+    counters.copies += record.copies;
+    counters.nanoseconds += record.duration;
+  }
+
+  std::map<std::string, Counters> counters() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return counters_;
+  }
+
+  void reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    counters_.clear();
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  std::map<std::string, Counters> counters_;
+};
+
+// ChromeTraceWriter
+// Streams the records as a JSON array of trace events. The array is closed
+// by close or by the destructor; the stream must outlive the writer.
+class ChromeTraceWriter : public Sink {
+ public:
+  explicit ChromeTraceWriter(std::ostream& output)
+      : output_(output), is_first_(true), is_closed_(false) {
+    output_ << "[";
+  }
+
+  ~ChromeTraceWriter() {
+    close();
+  }
+
+  void record(Record const& record) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (is_closed_) {
+      return;
+    }
+    output_ << (is_first_ ? "\n" : ",\n");
+    is_first_ = false;
+    output_ << "{\"name\":\"" << record.name
+        << "\",\"cat\":\"underscore\",\"ph\":\"X\",\"ts\":";
+    write_microseconds(record.start);
+    output_ << ",\"dur\":";
+    write_microseconds(record.duration);
+    output_ << ",\"pid\":1,\"tid\":" << record.thread
+        << ",\"args\":{\"elements\":";
+    if (record.elements == kUnknownElements) {
+      output_ << "\"unknown\"";
+    } else {
+      output_ << record.elements;
+    }
+    output_ << ",\"allocations\":" << record.allocations
+        << ",\"copies\":" << record.copies
+        << ",\"depth\":" << record.depth << "}}";
+  }
+
+  void close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!is_closed_) {
+      output_ << "\n]\n";
+      output_.flush();
+      is_closed_ = true;
+    }
+  }
+
+ private:
+  // Trace timestamps are in microseconds.
+  void write_microseconds(unsigned long long nanoseconds) {
+    char const fill = output_.fill('0');
+    output_ << nanoseconds / 1000 << '.' << std::setw(3) << nanoseconds % 1000;
+    output_.fill(fill);
+  }
+
+  std::mutex mutex_;
+  std::ostream& output_;
+  bool is_first_;
+  bool is_closed_;
+};
+
+}  // namespace instrument
+}  // namespace underscore
+
+#endif  // UNDERSCORE_INSTRUMENT_H_
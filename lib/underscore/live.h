@@ -0,0 +1,543 @@
+#ifndef UNDERSCORE_LIVE_H_
+#define UNDERSCORE_LIVE_H_
+
+// Results of reduce, max, min, group_by, count_by and filter that are kept up
+// to date while a container changes, for readers that look at the same
+// results again after every few changes, e.g. a dashboard refreshed every
+// tick. Instead of recomputing a result from the whole container, each change
+// updates it in O(1) or O(log n), except where noted for elements that have
+// no <, and reading it is O(1):
+//
+//   _::Live<std::multiset<Order> > orders = _::live(load_orders());
+//   auto const& revenue = orders.reduce(add_total, subtract_total, 0.0);
+//   auto const& largest = orders.max<double>(total);
+//   auto const& pending = orders.filter<std::unordered_multiset<Order> >(
+//       is_pending);
+//
+//   orders.insert(order);
+//   orders.update(order, shipped);
+//   display(revenue.value(), largest.value(), pending.value().size());
+//
+// Every change has to go through the Live wrapper, which applies it to the
+// container and passes it on to each of its views. An element is identified
+// by its value, so erase and update affect one element equal to the one
+// given, and the functions given to the views have to return the same result
+// for equal elements. The views are created from the current elements, which
+// is the one O(n) step, and are owned by the wrapper: the references it
+// returns stay valid, even when the wrapper is moved, until it is destroyed.
+//
+// This header requires C++11.
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "helper.h"
+
+namespace underscore {
+
+namespace helper {
+// Receives the changes made through a Live wrapper. An update is an erase
+// followed by an insert unless a view can do better.
+template<typename T>
+class LiveView {
+ public:
+  virtual ~LiveView() {
+  }
+
+  virtual void inserted(T const& value) = 0;
+  virtual void erased(T const& value) = 0;
+
+  virtual void updated(T const& old_value, T const& new_value) {
+    erased(old_value);
+    inserted(new_value);
+  }
+};
+
+// Finds an element equal to value with the container's own find where it
+// has one, e.g. sets and unordered sets, and with std::find otherwise.
+template<typename Container>
+auto live_find(
+    Container& container,
+    typename Container::value_type const& value,
+    int) -> decltype(container.find(value)) {
+  return container.find(value);
+}
+
+template<typename Container>
+typename Container::iterator live_find(
+    Container& container,
+    typename Container::value_type const& value,
+    long) {
+  return std::find(container.begin(), container.end(), value);
+}
+
+// Replaces an element in place where it is assignable, and otherwise, e.g.
+// in sets and maps, erases it and adds the new value.
+template<typename Container>
+auto live_replace(
+    Container&,
+    typename Container::iterator position,
+    typename Container::value_type const& value,
+    int) -> decltype(*position = value, void()) {
+  *position = value;
+}
+
+template<typename Container>
+void live_replace(
+    Container& container,
+    typename Container::iterator position,
+    typename Container::value_type const& value,
+    long) {
+  typename Container::value_type const replacement = value;
+  container.erase(position);
+  add_to_container(container, replacement);
+}
+
+// Erases one element equal to value, if there is one.
+template<typename Container>
+void live_erase(
+    Container& container,
+    typename Container::value_type const& value) {
+  typename Container::iterator const position =
+      live_find(container, value, 0);
+  if (position != container.end()) {
+    container.erase(position);
+  }
+}
+
+template<typename T>
+struct IsOrdered {
+  template<typename U>
+  static auto check(int) -> decltype(
+      std::declval<U const&>() < std::declval<U const&>(),
+      std::true_type());
+
+  template<typename U>
+  static std::false_type check(long);
+
+  static bool const value = decltype(check<T>(0))::value;
+};
+
+// Finds the entry of a LiveIndex holding a given key and element. Where the
+// elements are ordered with <, a handle to each entry is kept by key and
+// element, so finding one is O(log n) at the cost of a second copy of each
+// key and element.
+template<typename Key, typename T, bool = IsOrdered<T>::value>
+class LiveHandles {
+ public:
+  typedef typename std::multimap<Key, T>::iterator iterator;
+
+  void inserted(iterator position) {
+    handles_.insert(std::make_pair(
+        std::make_pair(position->first, position->second),
+        position));
+  }
+
+  // Removes the handle to an entry with the key and element and returns the
+  // entry, which the caller erases, or end if there is none.
+  iterator release(
+      std::multimap<Key, T>& index,
+      Key const& key,
+      T const& value) {
+    typename Handles::iterator const handle =
+        handles_.find(std::make_pair(key, value));
+    if (handle == handles_.end()) {
+      return index.end();
+    }
+    iterator const position = handle->second;
+    handles_.erase(handle);
+    return position;
+  }
+
+ private:
+  typedef std::multimap<std::pair<Key, T>, iterator> Handles;
+
+  Handles handles_;
+};
+
+// Elements without < can only be compared with ==, so the entries with an
+// equal key are searched, which takes time linear in their number.
+template<typename Key, typename T>
+class LiveHandles<Key, T, false> {
+ public:
+  typedef typename std::multimap<Key, T>::iterator iterator;
+
+  void inserted(iterator) {
+  }
+
+  iterator release(
+      std::multimap<Key, T>& index,
+      Key const& key,
+      T const& value) {
+    std::pair<iterator, iterator> const range = index.equal_range(key);
+    for (iterator i = range.first; i != range.second; ++i) {
+      if (i->second == value) {
+        return i;
+      }
+    }
+    return index.end();
+  }
+};
+
+// The elements ordered by a key, as a multimap like the one group_by
+// returns. Erasing takes O(log n) where the elements are ordered with <, and
+// otherwise searches the elements with an equal key for one equal to the
+// value.
+template<typename Key, typename T, typename Function>
+class LiveIndex : public LiveView<T> {
+ public:
+  template<typename Container>
+  LiveIndex(Container const& container, Function function)
+      : function_(function) {
+    for (typename Container::const_iterator i = container.begin();
+        i != container.end();
+        ++i) {
+      inserted(*i);
+    }
+  }
+
+  void inserted(T const& value) {
+    handles_.inserted(
+        index_.insert(std::pair<Key const, T>(function_(value), value)));
+  }
+
+  void erased(T const& value) {
+    typename std::multimap<Key, T>::iterator const position =
+        handles_.release(index_, function_(value), value);
+    if (position != index_.end()) {
+      index_.erase(position);
+    }
+  }
+
+ protected:
+  Function function_;
+  std::multimap<Key, T> index_;
+  LiveHandles<Key, T> handles_;
+};
+}  // namespace helper
+
+// reduce/inject/foldl
+// A running aggregate for reductions that can be undone: inverse(memo, value)
+// has to remove a value that function(memo, value) added, as subtraction
+// does for a sum or a count. Floating point sums drift slowly as values are
+// added and removed again, so long running totals of doubles should be
+// recomputed now and then.
+template<typename T, typename Function, typename Inverse, typename Memo>
+class LiveReduce : public helper::LiveView<T> {
+ public:
+  template<typename Container>
+  LiveReduce(
+      Container const& container,
+      Function function,
+      Inverse inverse,
+      Memo memo)
+      : function_(function), inverse_(inverse), memo_(memo) {
+    for (typename Container::const_iterator i = container.begin();
+        i != container.end();
+        ++i) {
+      memo_ = function_(memo_, *i);
+    }
+  }
+
+  void inserted(T const& value) {
+    memo_ = function_(memo_, value);
+  }
+
+  void erased(T const& value) {
+    memo_ = inverse_(memo_, value);
+  }
+
+  Memo const& value() const {
+    return memo_;
+  }
+
+ private:
+  Function function_;
+  Inverse inverse_;
+  Memo memo_;
+};
+
+// max/min
+// One of the elements with the largest (max) or smallest (min) key, which is
+// the element itself unless a key function is given. When several elements
+// share that key, which of them is returned is unspecified.
+template<typename Compared, typename T, typename Function>
+class LiveExtreme : public helper::LiveIndex<Compared, T, Function> {
+ public:
+  template<typename Container>
+  LiveExtreme(Container const& container, Function function, bool largest)
+      : helper::LiveIndex<Compared, T, Function>(container, function),
+        largest_(largest) {
+  }
+
+  bool empty() const {
+    return this->index_.empty();
+  }
+
+  // The container must not be empty.
+  T const& value() const {
+    return largest_ ?
+        this->index_.rbegin()->second :
+        this->index_.begin()->second;
+  }
+
+ private:
+  bool const largest_;
+};
+
+// group_by
+template<typename Key, typename T, typename Function>
+class LiveGroupBy : public helper::LiveIndex<Key, T, Function> {
+ public:
+  template<typename Container>
+  LiveGroupBy(Container const& container, Function function)
+      : helper::LiveIndex<Key, T, Function>(container, function) {
+  }
+
+  std::multimap<Key, T> const& value() const {
+    return this->index_;
+  }
+};
+
+// count_by
+// The number of elements with each key. Keys are removed once no element has
+// them.
+template<typename Key, typename T, typename Function>
+class LiveCountBy : public helper::LiveView<T> {
+ public:
+  template<typename Container>
+  LiveCountBy(Container const& container, Function function)
+      : function_(function) {
+    for (typename Container::const_iterator i = container.begin();
+        i != container.end();
+        ++i) {
+      inserted(*i);
+    }
+  }
+
+  void inserted(T const& value) {
+    ++counts_[function_(value)];
+  }
+
+  void erased(T const& value) {
+    typename std::map<Key, std::size_t>::iterator const count =
+        counts_.find(function_(value));
+    if (count != counts_.end() && --count->second == 0) {
+      counts_.erase(count);
+    }
+  }
+
+  void updated(T const& old_value, T const& new_value) {
+    Key const old_key = function_(old_value);
+    Key const new_key = function_(new_value);
+    if (old_key < new_key || new_key < old_key) {
+      erased(old_value);
+      inserted(new_value);
+    }
+  }
+
+  std::map<Key, std::size_t> const& value() const {
+    return counts_;
+  }
+
+  std::size_t count(Key const& key) const {
+    typename std::map<Key, std::size_t>::const_iterator const count =
+        counts_.find(key);
+    return count == counts_.end() ? 0 : count->second;
+  }
+
+ private:
+  Function function_;
+  std::map<Key, std::size_t> counts_;
+};
+
+// filter/select
+// The elements that pass a predicate, in a result container of the caller's
+// choice. Elements are erased from it with its own find where it has one, so
+// a std::multiset or std::unordered_multiset keeps erasing cheap, while a
+// std::vector has to be searched.
+template<typename ResultContainer, typename T, typename Predicate>
+class LiveFilter : public helper::LiveView<T> {
+ public:
+  template<typename Container>
+  LiveFilter(Container const& container, Predicate predicate)
+      : predicate_(predicate) {
+    for (typename Container::const_iterator i = container.begin();
+        i != container.end();
+        ++i) {
+      inserted(*i);
+    }
+  }
+
+  void inserted(T const& value) {
+    if (predicate_(value)) {
+      helper::add_to_container(result_, value);
+    }
+  }
+
+  void erased(T const& value) {
+    if (predicate_(value)) {
+      helper::live_erase(result_, value);
+    }
+  }
+
+  ResultContainer const& value() const {
+    return result_;
+  }
+
+ private:
+  Predicate predicate_;
+  ResultContainer result_;
+};
+
+// Live
+// Wraps a container so that changes to it keep the views created from it up
+// to date. value() gives read access to the container itself. erase and
+// update find the element with the container's own find where it has one, so
+// they take O(log n) or O(1) in sets and unordered sets, but search a
+// std::vector or std::list from the front.
+template<typename Container>
+class Live {
+ public:
+  typedef typename Container::value_type value_type;
+
+  explicit Live(Container container) : container_(std::move(container)) {
+  }
+
+  Container const& value() const {
+    return container_;
+  }
+
+  std::size_t size() const {
+    return container_.size();
+  }
+
+  void insert(value_type value) {
+    helper::add_to_container(container_, value);
+    for (std::size_t i = 0; i < views_.size(); ++i) {
+      views_[i]->inserted(value);
+    }
+  }
+
+  // Erases one element equal to value. Returns false if there is none.
+  bool erase(value_type const& value) {
+    typename Container::iterator const position =
+        helper::live_find(container_, value, 0);
+    if (position == container_.end()) {
+      return false;
+    }
+    for (std::size_t i = 0; i < views_.size(); ++i) {
+      views_[i]->erased(*position);
+    }
+    container_.erase(position);
+    return true;
+  }
+
+  // Replaces one element equal to old_value with new_value. Returns false if
+  // there is none.
+  bool update(value_type const& old_value, value_type const& new_value) {
+    typename Container::iterator const position =
+        helper::live_find(container_, old_value, 0);
+    if (position == container_.end()) {
+      return false;
+    }
+    for (std::size_t i = 0; i < views_.size(); ++i) {
+      views_[i]->updated(*position, new_value);
+    }
+    helper::live_replace(container_, position, new_value, 0);
+    return true;
+  }
+
+  // reduce/inject/foldl
+  template<typename Function, typename Inverse, typename Memo>
+  LiveReduce<value_type, Function, Inverse, Memo> const& reduce(
+      Function function,
+      Inverse inverse,
+      Memo memo) {
+    return add_view(new LiveReduce<value_type, Function, Inverse, Memo>(
+        container_,
+        function,
+        inverse,
+        memo));
+  }
+
+  // max
+  LiveExtreme<value_type, value_type, helper::Identity<value_type> > const&
+  max() {
+    return max<value_type>(helper::Identity<value_type>());
+  }
+
+  template<typename Compared, typename Function>
+  LiveExtreme<Compared, value_type, Function> const& max(Function function) {
+    return add_view(new LiveExtreme<Compared, value_type, Function>(
+        container_,
+        function,
+        true));
+  }
+
+  // min
+  LiveExtreme<value_type, value_type, helper::Identity<value_type> > const&
+  min() {
+    return min<value_type>(helper::Identity<value_type>());
+  }
+
+  template<typename Compared, typename Function>
+  LiveExtreme<Compared, value_type, Function> const& min(Function function) {
+    return add_view(new LiveExtreme<Compared, value_type, Function>(
+        container_,
+        function,
+        false));
+  }
+
+  // group_by
+  template<typename Key, typename Function>
+  LiveGroupBy<Key, value_type, Function> const& group_by(Function function) {
+    return add_view(new LiveGroupBy<Key, value_type, Function>(
+        container_,
+        function));
+  }
+
+  // count_by
+  template<typename Key, typename Function>
+  LiveCountBy<Key, value_type, Function> const& count_by(Function function) {
+    return add_view(new LiveCountBy<Key, value_type, Function>(
+        container_,
+        function));
+  }
+
+  // filter/select
+  template<typename ResultContainer, typename Predicate>
+  LiveFilter<ResultContainer, value_type, Predicate> const& filter(
+      Predicate predicate) {
+    return add_view(new LiveFilter<ResultContainer, value_type, Predicate>(
+        container_,
+        predicate));
+  }
+
+ private:
+  template<typename View>
+  View const& add_view(View* view) {
+    std::unique_ptr<helper::LiveView<value_type> > owned(view);
+    views_.push_back(std::move(owned));
+    return *view;
+  }
+
+  Container container_;
+  std::vector<std::unique_ptr<helper::LiveView<value_type> > > views_;
+};
+
+// live
+template<typename Container>
+Live<Container> live(Container container) {
+  return Live<Container>(std::move(container));
+}
+
+}  // namespace underscore
+
+#endif  // UNDERSCORE_LIVE_H_
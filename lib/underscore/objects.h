@@ -0,0 +1,35 @@
+#ifndef UNDERSCORE_OBJECTS_H_
+#define UNDERSCORE_OBJECTS_H_
+
+// Objects: none of the Underscore.js object helpers are implemented yet.
+
+#include "helper.h"
+
+namespace underscore {
+
+// keys
+// values
+// functions
+// extend
+// defaults
+// clone
+// tap
+// has
+// isEqual
+// isEmpty
+// isElement
+// isArray
+// isArguments
+// isFunction
+// isString
+// isNumber
+// isBoolean
+// isDate
+// isRegExp
+// isNaN
+// isNull
+// isUndefined
+
+}  // namespace underscore
+
+#endif  // UNDERSCORE_OBJECTS_H_
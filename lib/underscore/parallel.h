@@ -0,0 +1,91 @@
+#ifndef UNDERSCORE_PARALLEL_H_
+#define UNDERSCORE_PARALLEL_H_
+
+// The threads behind the parallel variants of the Collections functions,
+// kept out of helper.h so that only the headers defining parallel variants
+// pull in <thread>.
+//
+// This header requires C++11.
+
+#if __cplusplus < 201103L
+#error "underscore/parallel.h requires C++11"
+#endif
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace underscore {
+
+namespace helper {
+
+// The parallel variants of Underscore functions split their input into
+// contiguous index ranges and hand each range to its own thread. The calling
+// thread takes the last range, so a single worker never spawns a thread. If
+// a range throws, the first exception is rethrown once every thread has
+// finished.
+inline unsigned default_workers() {
+  unsigned const workers = std::thread::hardware_concurrency();
+  return workers ? workers : 1;
+}
+
+template<typename Body>
+void parallel_for(std::size_t count, unsigned workers, Body body) {
+  if (count == 0) {
+    return;
+  }
+  if (workers == 0) {
+    workers = default_workers();
+  }
+  if (workers > count) {
+    workers = static_cast<unsigned>(count);
+  }
+
+  std::atomic<bool> failed(false);
+  std::exception_ptr error;
+  auto const run = [&](std::size_t begin, std::size_t end) {
+    try {
+      body(begin, end);
+    } catch (...) {
+      if (!failed.exchange(true)) {
+        error = std::current_exception();
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(workers - 1);
+  std::size_t const chunk = count / workers;
+  std::size_t const remainder = count % workers;
+  std::size_t begin = 0;
+  try {
+    for (unsigned worker = 0; worker < workers; ++worker) {
+      std::size_t const end = begin + chunk + (worker < remainder ? 1 : 0);
+      if (worker + 1 == workers) {
+        run(begin, end);
+      } else {
+        threads.emplace_back(run, begin, end);
+      }
+      begin = end;
+    }
+  } catch (...) {
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+    throw;
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+}  // namespace helper
+
+}  // namespace underscore
+
+#endif  // UNDERSCORE_PARALLEL_H_
@@ -0,0 +1,542 @@
+#ifndef UNDERSCORE_SKETCH_H_
+#define UNDERSCORE_SKETCH_H_
+
+// Approximate, fixed size summaries of large inputs, for when the exact
+// answers of uniq, include or max cost far more memory than they are worth.
+// Each sketch can be built from a container (optionally through a key
+// function, as with uniq and group_by) or filled one element at a time, and
+// sketches with the same parameters can be merged, so each thread can
+// summarize its own part of the input and the results can be combined.
+// Merging a sketch with one of a different size throws
+// std::invalid_argument.
+//
+// Keys are hashed with std::hash.
+//
+// This header requires C++11.
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "helper.h"
+
+namespace underscore {
+
+namespace helper {
+// The sketches take their bits from the whole 64 bit hash, so std::hash is
+// finalized to 64 bits even where std::size_t is narrower.
+template<typename Key>
+unsigned long long hash64(Key const& key) {
+  unsigned long long hash = std::hash<Key>()(key);
+  hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebULL;
+  return hash ^ (hash >> 31);
+}
+
+inline unsigned leading_zeros(unsigned long long value) {
+  unsigned zeros = 0;
+  for (unsigned long long bit = 1ULL << 63; bit && !(value & bit); bit >>= 1) {
+    ++zeros;
+  }
+  return zeros;
+}
+}  // namespace helper
+
+// HyperLogLog
+// Estimates the number of distinct keys with 2^precision one byte registers.
+// The standard error is about 1.04 / sqrt(2^precision), e.g. 0.8% for the
+// default precision of 14, which takes 16 KB.
+template<typename Key>
+class HyperLogLog {
+ public:
+  explicit HyperLogLog(unsigned precision = 14)
+      : precision_(std::max(4u, std::min(precision, 18u))),
+        registers_(std::size_t(1) << precision_, 0) {
+  }
+
+  void insert(Key const& key) {
+    unsigned long long const hash = helper::hash64(key);
+    std::size_t const index = static_cast<std::size_t>(
+        hash >> (64 - precision_));
+    unsigned long long const remaining = hash << precision_;
+    unsigned char const rank = static_cast<unsigned char>(
+        std::min(helper::leading_zeros(remaining), 64 - precision_) + 1);
+    if (registers_[index] < rank) {
+      registers_[index] = rank;
+    }
+  }
+
+  // Both sketches must have the same precision.
+  void merge(HyperLogLog const& other) {
+    if (other.precision_ != precision_) {
+      throw std::invalid_argument(
+          "merging HyperLogLog sketches of different precisions");
+    }
+    for (std::size_t i = 0; i < registers_.size(); ++i) {
+      registers_[i] = std::max(registers_[i], other.registers_[i]);
+    }
+  }
+
+  std::size_t count() const {
+    double const m = static_cast<double>(registers_.size());
+    double sum = 0;
+    std::size_t zeros = 0;
+    for (std::size_t i = 0; i < registers_.size(); ++i) {
+      sum += std::ldexp(1.0, -registers_[i]);
+      zeros += registers_[i] == 0;
+    }
+    double estimate = alpha() * m * m / sum;
+    // Small cardinalities are estimated better by linear counting.
+    if (estimate <= 2.5 * m && zeros) {
+      estimate = m * std::log(m / static_cast<double>(zeros));
+    }
+    return static_cast<std::size_t>(estimate + 0.5);
+  }
+
+  unsigned precision() const {
+    return precision_;
+  }
+
+ private:
+  double alpha() const {
+    switch (registers_.size()) {
+      case 16:
+        return 0.673;
+      case 32:
+        return 0.697;
+      case 64:
+        return 0.709;
+      default:
+        return 0.7213 / (1 + 1.079 / registers_.size());
+    }
+  }
+
+  unsigned precision_;
+  std::vector<unsigned char> registers_;
+};
+
+// approx_count_distinct
+template<typename Key, typename Container, typename Function>
+HyperLogLog<Key> hyper_log_log(
+    Container const& container,
+    Function function,
+    unsigned precision) {
+  HyperLogLog<Key> sketch(precision);
+  for (typename Container::const_iterator i = container.begin();
+      i != container.end();
+      ++i) {
+    sketch.insert(function(*i));
+  }
+  return sketch;
+}
+
+template<typename Container>
+HyperLogLog<typename Container::value_type> hyper_log_log(
+    Container const& container,
+    unsigned precision) {
+  return hyper_log_log<typename Container::value_type>(
+      container,
+      helper::Identity<typename Container::value_type>(),
+      precision);
+}
+
+template<typename Key, typename Container, typename Function>
+std::size_t approx_count_distinct(
+    Container const& container,
+    Function function,
+    unsigned precision) {
+  return hyper_log_log<Key>(container, function, precision).count();
+}
+
+template<typename Key, typename Container, typename Function>
+std::size_t approx_count_distinct(
+    Container const& container,
+    Function function) {
+  return approx_count_distinct<Key>(container, function, 14);
+}
+
+template<typename Container>
+std::size_t approx_count_distinct(
+    Container const& container,
+    unsigned precision) {
+  return hyper_log_log(container, precision).count();
+}
+
+template<typename Container>
+std::size_t approx_count_distinct(Container const& container) {
+  return approx_count_distinct(container, 14);
+}
+
+// BloomFilter
+// A probabilistic set: contains never misses a key that was inserted, and
+// wrongly reports one that wasn't at roughly the false positive rate it was
+// sized for. Its size depends only on the expected count and the rate, so
+// filters built over different parts of an input can be merged when they are
+// given the same expected count, e.g. that of the whole input.
+template<typename Key>
+class BloomFilter {
+ public:
+  BloomFilter(std::size_t expected_count, double false_positive_rate) {
+    double const n = static_cast<double>(std::max<std::size_t>(
+        expected_count,
+        1));
+    double const ln2 = std::log(2.0);
+    double const bits = -n * std::log(false_positive_rate) / (ln2 * ln2);
+    words_.assign(
+        std::max<std::size_t>(static_cast<std::size_t>(bits / 64) + 1, 1),
+        0);
+    hashes_ = std::max(1u, static_cast<unsigned>(
+        std::floor(bits / n * ln2 + 0.5)));
+  }
+
+  void insert(Key const& key) {
+    unsigned long long const hash = helper::hash64(key);
+    for (unsigned i = 0; i < hashes_; ++i) {
+      std::size_t const bit = position(hash, i);
+      words_[bit / 64] |= 1ULL << (bit % 64);
+    }
+  }
+
+  bool contains(Key const& key) const {
+    unsigned long long const hash = helper::hash64(key);
+    for (unsigned i = 0; i < hashes_; ++i) {
+      std::size_t const bit = position(hash, i);
+      if (!(words_[bit / 64] & (1ULL << (bit % 64)))) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Both filters must have been sized identically.
+  void merge(BloomFilter const& other) {
+    if (other.words_.size() != words_.size() || other.hashes_ != hashes_) {
+      throw std::invalid_argument(
+          "merging Bloom filters of different sizes");
+    }
+    for (std::size_t i = 0; i < words_.size(); ++i) {
+      words_[i] |= other.words_[i];
+    }
+  }
+
+ private:
+  // Double hashing derives every probe from the two halves of one hash.
+  std::size_t position(unsigned long long hash, unsigned i) const {
+    unsigned long long const first = hash & 0xffffffffULL;
+    unsigned long long const second = (hash >> 32) | 1;
+    return static_cast<std::size_t>((first + i * second) % (words_.size() * 64));
+  }
+
+  std::vector<unsigned long long> words_;
+  unsigned hashes_;
+};
+
+// bloom_filter
+// Without an expected count the filter is sized for the container itself.
+template<typename Key, typename Container, typename Function>
+BloomFilter<Key> bloom_filter(
+    Container const& container,
+    Function function,
+    std::size_t expected_count,
+    double false_positive_rate) {
+  BloomFilter<Key> filter(expected_count, false_positive_rate);
+  for (typename Container::const_iterator i = container.begin();
+      i != container.end();
+      ++i) {
+    filter.insert(function(*i));
+  }
+  return filter;
+}
+
+template<typename Key, typename Container, typename Function>
+BloomFilter<Key> bloom_filter(
+    Container const& container,
+    Function function,
+    double false_positive_rate) {
+  return bloom_filter<Key>(
+      container,
+      function,
+      container.size(),
+      false_positive_rate);
+}
+
+template<typename Container>
+BloomFilter<typename Container::value_type> bloom_filter(
+    Container const& container,
+    std::size_t expected_count,
+    double false_positive_rate) {
+  return bloom_filter<typename Container::value_type>(
+      container,
+      helper::Identity<typename Container::value_type>(),
+      expected_count,
+      false_positive_rate);
+}
+
+template<typename Container>
+BloomFilter<typename Container::value_type> bloom_filter(
+    Container const& container,
+    double false_positive_rate) {
+  return bloom_filter<typename Container::value_type>(
+      container,
+      helper::Identity<typename Container::value_type>(),
+      false_positive_rate);
+}
+
+// CountMin
+// Estimates how often each key occurs. An estimate is never too low, and with
+// probability 1 - delta it is too high by at most epsilon times the total
+// count.
+template<typename Key>
+class CountMin {
+ public:
+  CountMin(double epsilon, double delta)
+      : width_(std::max<std::size_t>(
+            static_cast<std::size_t>(std::ceil(std::exp(1.0) / epsilon)),
+            1)),
+        depth_(std::max<std::size_t>(
+            static_cast<std::size_t>(std::ceil(std::log(1 / delta))),
+            1)),
+        counts_(width_ * depth_, 0) {
+  }
+
+  void insert(Key const& key, unsigned long long count = 1) {
+    unsigned long long const hash = helper::hash64(key);
+    for (std::size_t row = 0; row < depth_; ++row) {
+      counts_[row * width_ + column(hash, row)] += count;
+    }
+  }
+
+  unsigned long long estimate(Key const& key) const {
+    unsigned long long const hash = helper::hash64(key);
+    unsigned long long minimum = counts_[column(hash, 0)];
+    for (std::size_t row = 1; row < depth_; ++row) {
+      minimum = std::min(minimum, counts_[row * width_ + column(hash, row)]);
+    }
+    return minimum;
+  }
+
+  // Both sketches must have the same epsilon and delta.
+  void merge(CountMin const& other) {
+    if (other.width_ != width_ || other.depth_ != depth_) {
+      throw std::invalid_argument(
+          "merging CountMin sketches of different sizes");
+    }
+    for (std::size_t i = 0; i < counts_.size(); ++i) {
+      counts_[i] += other.counts_[i];
+    }
+  }
+
+ private:
+  std::size_t column(unsigned long long hash, std::size_t row) const {
+    unsigned long long const first = hash & 0xffffffffULL;
+    unsigned long long const second = (hash >> 32) | 1;
+    return static_cast<std::size_t>((first + row * second) % width_);
+  }
+
+  std::size_t width_;
+  std::size_t depth_;
+  std::vector<unsigned long long> counts_;
+};
+
+// count_min
+template<typename Key, typename Container, typename Function>
+CountMin<Key> count_min(
+    Container const& container,
+    Function function,
+    double epsilon,
+    double delta) {
+  CountMin<Key> sketch(epsilon, delta);
+  for (typename Container::const_iterator i = container.begin();
+      i != container.end();
+      ++i) {
+    sketch.insert(function(*i));
+  }
+  return sketch;
+}
+
+template<typename Container>
+CountMin<typename Container::value_type> count_min(
+    Container const& container,
+    double epsilon,
+    double delta) {
+  return count_min<typename Container::value_type>(
+      container,
+      helper::Identity<typename Container::value_type>(),
+      epsilon,
+      delta);
+}
+
+// QuantileSketch
+// A KLL sketch: values are kept in a stack of compactors, where an element on
+// level h stands for 2^h inputs. When a level fills up it is sorted and every
+// other element, starting at a random one, is promoted to the next level.
+// The rank error is roughly 1.7 / k, and the size stays O(k) no matter how
+// many values are inserted. T only needs to be ordered with <.
+template<typename T>
+class QuantileSketch {
+ public:
+  explicit QuantileSketch(std::size_t k = 200)
+      : k_(std::max<std::size_t>(k, 8)),
+        count_(0),
+        random_(0x9e3779b97f4a7c15ULL),
+        levels_(1) {
+  }
+
+  void insert(T const& value) {
+    levels_[0].push_back(value);
+    ++count_;
+    if (levels_[0].size() >= capacity(0)) {
+      compress();
+    }
+  }
+
+  // Both sketches must have the same k. A sketch can be merged into itself.
+  void merge(QuantileSketch const& other) {
+    if (other.k_ != k_) {
+      throw std::invalid_argument(
+          "merging quantile sketches with different k");
+    }
+    // Copied first, since inserting a level into itself would read from a
+    // vector that is reallocating.
+    std::vector<std::vector<T> > const merged = other.levels_;
+    std::size_t const count = other.count_;
+    if (levels_.size() < merged.size()) {
+      levels_.resize(merged.size());
+    }
+    for (std::size_t level = 0; level < merged.size(); ++level) {
+      levels_[level].insert(
+          levels_[level].end(),
+          merged[level].begin(),
+          merged[level].end());
+    }
+    count_ += count;
+    compress();
+  }
+
+  // The value at quantile q, from 0 (the minimum) to 1 (the maximum). An
+  // empty sketch returns T().
+  T quantile(double q) const {
+    std::vector<std::pair<T, unsigned long long> > weighted;
+    for (std::size_t level = 0; level < levels_.size(); ++level) {
+      for (std::size_t i = 0; i < levels_[level].size(); ++i) {
+        weighted.push_back(std::make_pair(levels_[level][i], 1ULL << level));
+      }
+    }
+    if (weighted.empty()) {
+      return T();
+    }
+    std::sort(weighted.begin(), weighted.end(), WeightedLess());
+
+    unsigned long long total = 0;
+    for (std::size_t i = 0; i < weighted.size(); ++i) {
+      total += weighted[i].second;
+    }
+    double const target = std::max(0.0, std::min(q, 1.0)) * total;
+    unsigned long long cumulative = 0;
+    for (std::size_t i = 0; i < weighted.size(); ++i) {
+      cumulative += weighted[i].second;
+      if (cumulative >= target) {
+        return weighted[i].first;
+      }
+    }
+    return weighted.back().first;
+  }
+
+  std::size_t count() const {
+    return count_;
+  }
+
+ private:
+  struct WeightedLess {
+    bool operator()(
+        std::pair<T, unsigned long long> const& left,
+        std::pair<T, unsigned long long> const& right) const {
+      return left.first < right.first;
+    }
+  };
+
+  // Capacities shrink geometrically by 2/3 going down from the top level.
+  std::size_t capacity(std::size_t level) const {
+    double const depth = static_cast<double>(levels_.size() - 1 - level);
+    return std::max<std::size_t>(
+        static_cast<std::size_t>(std::ceil(k_ * std::pow(2.0 / 3.0, depth))),
+        2);
+  }
+
+  void compress() {
+    for (std::size_t level = 0; level < levels_.size(); ++level) {
+      if (levels_[level].size() < capacity(level)) {
+        continue;
+      }
+      if (level + 1 == levels_.size()) {
+        levels_.resize(levels_.size() + 1);
+      }
+      std::vector<T>& compacting = levels_[level];
+      std::sort(compacting.begin(), compacting.end());
+      // An odd element out stays behind on this level.
+      T leftover = compacting.back();
+      bool const has_leftover = compacting.size() % 2 == 1;
+      if (has_leftover) {
+        compacting.pop_back();
+      }
+      for (std::size_t i = next_random() & 1; i < compacting.size(); i += 2) {
+        levels_[level + 1].push_back(compacting[i]);
+      }
+      compacting.clear();
+      if (has_leftover) {
+        compacting.push_back(leftover);
+      }
+    }
+  }
+
+  unsigned long long next_random() {
+    random_ ^= random_ << 13;
+    random_ ^= random_ >> 7;
+    random_ ^= random_ << 17;
+    return random_;
+  }
+
+  std::size_t k_;
+  std::size_t count_;
+  unsigned long long random_;
+  std::vector<std::vector<T> > levels_;
+};
+
+// quantile_sketch
+template<typename Key, typename Container, typename Function>
+QuantileSketch<Key> quantile_sketch(
+    Container const& container,
+    Function function,
+    std::size_t k) {
+  QuantileSketch<Key> sketch(k);
+  for (typename Container::const_iterator i = container.begin();
+      i != container.end();
+      ++i) {
+    sketch.insert(function(*i));
+  }
+  return sketch;
+}
+
+template<typename Container>
+QuantileSketch<typename Container::value_type> quantile_sketch(
+    Container const& container,
+    std::size_t k) {
+  return quantile_sketch<typename Container::value_type>(
+      container,
+      helper::Identity<typename Container::value_type>(),
+      k);
+}
+
+template<typename Container>
+QuantileSketch<typename Container::value_type> quantile_sketch(
+    Container const& container) {
+  return quantile_sketch(container, 200);
+}
+
+}  // namespace underscore
+
+#endif  // UNDERSCORE_SKETCH_H_
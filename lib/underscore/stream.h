@@ -0,0 +1,559 @@
+#ifndef UNDERSCORE_STREAM_H_
+#define UNDERSCORE_STREAM_H_
+
+// Sources that let the Underscore functions read straight from files instead
+// of from an in-memory container. Every source exposes the container
+// interface (value_type, iterator, const_iterator, begin and end). Most of
+// the functions take their containers by const reference; the few that take
+// them by value, e.g. invoke and sorted_index, only copy a path or a shared
+// mapping. None of the sources ever holds more than a bounded window of the
+// file in memory, and the memory mapped sources don't copy the file contents
+// at all.
+//
+// Opening a file that can't be read, or an error while reading one, throws
+// std::runtime_error.
+//
+// This header requires C++11.
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define UNDERSCORE_HAS_MMAP 1
+#endif
+
+#include "arrays.h"
+
+namespace underscore {
+
+namespace helper {
+inline std::runtime_error file_error(std::string const& path) {
+  return std::runtime_error(path + ": " + std::strerror(errno));
+}
+
+struct FileCloser {
+  void operator()(std::FILE* file) const {
+    std::fclose(file);
+  }
+};
+
+inline std::shared_ptr<std::FILE> open_file(std::string const& path) {
+  std::FILE* file = std::fopen(path.c_str(), "rb");
+  if (!file) {
+    throw file_error(path);
+  }
+  return std::shared_ptr<std::FILE>(file, FileCloser());
+}
+
+// fread, except that a short read is only the end of the file if the stream
+// has no error, so that a failing disk doesn't silently truncate the input.
+inline std::size_t read_file(
+    void* buffer,
+    std::size_t size,
+    std::size_t count,
+    std::FILE* file,
+    std::string const& path) {
+  std::size_t const read = std::fread(buffer, size, count, file);
+  if (read < count && std::ferror(file)) {
+    throw file_error(path);
+  }
+  return read;
+}
+}  // namespace helper
+
+#ifdef UNDERSCORE_HAS_MMAP
+// MappedFile
+// A read only mapping of a whole file. The mapping is released when the last
+// copy goes away.
+class MappedFile {
+ public:
+  explicit MappedFile(std::string const& path) {
+    int const descriptor = ::open(path.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+      throw helper::file_error(path);
+    }
+    struct stat status;
+    if (::fstat(descriptor, &status) != 0) {
+      ::close(descriptor);
+      throw helper::file_error(path);
+    }
+    std::size_t const size = static_cast<std::size_t>(status.st_size);
+    char const* data = 0;
+    if (size) {
+      void* mapped = ::mmap(0, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+      if (mapped == MAP_FAILED) {
+        ::close(descriptor);
+        throw helper::file_error(path);
+      }
+      // The sources read front to back, so let the kernel read ahead.
+      ::madvise(mapped, size, MADV_SEQUENTIAL);
+      data = static_cast<char const*>(mapped);
+    }
+    ::close(descriptor);
+    mapping_ = std::shared_ptr<Mapping>(new Mapping(data, size));
+  }
+
+  char const* data() const {
+    return mapping_->data;
+  }
+
+  std::size_t size() const {
+    return mapping_->size;
+  }
+
+ private:
+  struct Mapping {
+    Mapping(char const* data, std::size_t size) : data(data), size(size) {
+    }
+
+    ~Mapping() {
+      if (size) {
+        ::munmap(const_cast<char*>(data), size);
+      }
+    }
+
+    char const* data;
+    std::size_t size;
+  };
+
+  std::shared_ptr<Mapping> mapping_;
+};
+
+// mapped_records
+// A memory mapped file of fixed size binary records of type T, viewed as a
+// random access container of T. Trailing bytes that don't make up a whole
+// record are ignored.
+template<typename T>
+class MappedRecords {
+  static_assert(
+      std::is_trivially_copyable<T>::value,
+      "mapped records must be trivially copyable");
+
+ public:
+  typedef T value_type;
+  typedef T const* iterator;
+  typedef T const* const_iterator;
+  typedef std::reverse_iterator<T const*> reverse_iterator;
+  typedef std::reverse_iterator<T const*> const_reverse_iterator;
+  typedef std::size_t size_type;
+
+  explicit MappedRecords(MappedFile const& file) : file_(file) {
+  }
+
+  const_iterator begin() const {
+    return reinterpret_cast<T const*>(file_.data());
+  }
+
+  const_iterator end() const {
+    return begin() + size();
+  }
+
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+
+  size_type size() const {
+    return file_.size() / sizeof(T);
+  }
+
+  bool empty() const {
+    return size() == 0;
+  }
+
+ private:
+  MappedFile file_;
+};
+
+template<typename T>
+MappedRecords<T> mapped_records(std::string const& path) {
+  return MappedRecords<T>(MappedFile(path));
+}
+
+// mapped_lines
+// The lines of a memory mapped text file, each as a Slice of the mapped
+// characters without its line terminator, which is either "\n" or "\r\n". A
+// final line without a trailing newline is still included.
+class MappedLines {
+ public:
+  typedef Slice<char const*> value_type;
+  typedef std::size_t size_type;
+
+  class iterator {
+   public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef Slice<char const*> value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef Slice<char const*> const* pointer;
+    typedef Slice<char const*> reference;
+
+    iterator(char const* position, char const* end)
+        : position_(position), end_(end), line_end_(find_line_end()) {
+    }
+
+    Slice<char const*> operator*() const {
+      char const* end = line_end_;
+      if (end != end_ && end != position_ && end[-1] == '\r') {
+        --end;
+      }
+      return Slice<char const*>(
+          position_,
+          end,
+          static_cast<std::size_t>(end - position_));
+    }
+
+    iterator& operator++() {
+      position_ = line_end_ == end_ ? end_ : line_end_ + 1;
+      line_end_ = find_line_end();
+      return *this;
+    }
+
+    iterator operator++(int) {
+      iterator previous = *this;
+      ++*this;
+      return previous;
+    }
+
+    bool operator==(iterator const& other) const {
+      return position_ == other.position_;
+    }
+
+    bool operator!=(iterator const& other) const {
+      return !(*this == other);
+    }
+
+   private:
+    char const* find_line_end() const {
+      if (position_ == end_) {
+        return end_;
+      }
+      char const* newline = static_cast<char const*>(
+          std::memchr(position_, '\n', end_ - position_));
+      return newline ? newline : end_;
+    }
+
+    char const* position_;
+    char const* end_;
+    char const* line_end_;
+  };
+  typedef iterator const_iterator;
+
+  explicit MappedLines(MappedFile const& file) : file_(file) {
+  }
+
+  iterator begin() const {
+    return iterator(file_.data(), file_.data() + file_.size());
+  }
+
+  iterator end() const {
+    return iterator(file_.data() + file_.size(), file_.data() + file_.size());
+  }
+
+ private:
+  MappedFile file_;
+};
+
+inline MappedLines mapped_lines(std::string const& path) {
+  return MappedLines(MappedFile(path));
+}
+#endif  // UNDERSCORE_HAS_MMAP
+
+// record_file
+// A file of fixed size binary records of type T, read `buffered` records at a
+// time. This is a single pass source: each call to begin opens the file
+// again, and the iterators it returns are input iterators.
+template<typename T>
+class RecordFile {
+  static_assert(
+      std::is_trivially_copyable<T>::value,
+      "records must be trivially copyable");
+
+ public:
+  typedef T value_type;
+  typedef std::size_t size_type;
+
+  class iterator {
+   public:
+    typedef std::input_iterator_tag iterator_category;
+    typedef T value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef T const* pointer;
+    typedef T const& reference;
+
+    iterator() {
+    }
+
+    iterator(
+        std::shared_ptr<std::FILE> const& file,
+        std::string const& path,
+        size_type buffered)
+        : reader_(new Reader(file, path, buffered)) {
+      if (!reader_->next()) {
+        reader_.reset();
+      }
+    }
+
+    T const& operator*() const {
+      return reader_->current();
+    }
+
+    T const* operator->() const {
+      return &reader_->current();
+    }
+
+    iterator& operator++() {
+      if (!reader_->next()) {
+        reader_.reset();
+      }
+      return *this;
+    }
+
+    void operator++(int) {
+      ++*this;
+    }
+
+    bool operator==(iterator const& other) const {
+      return reader_ == other.reader_;
+    }
+
+    bool operator!=(iterator const& other) const {
+      return !(*this == other);
+    }
+
+   private:
+    class Reader {
+     public:
+      Reader(
+          std::shared_ptr<std::FILE> const& file,
+          std::string const& path,
+          size_type buffered)
+          : file_(file),
+            path_(path),
+            buffer_(buffered ? buffered : 1),
+            index_(0),
+            count_(0) {
+      }
+
+      T const& current() const {
+        return buffer_[index_];
+      }
+
+      bool next() {
+        if (count_ && ++index_ < count_) {
+          return true;
+        }
+        count_ = helper::read_file(
+            &buffer_[0],
+            sizeof(T),
+            buffer_.size(),
+            file_.get(),
+            path_);
+        index_ = 0;
+        return count_ != 0;
+      }
+
+     private:
+      std::shared_ptr<std::FILE> file_;
+      std::string path_;
+      std::vector<T> buffer_;
+      size_type index_;
+      size_type count_;
+    };
+
+    std::shared_ptr<Reader> reader_;
+  };
+  typedef iterator const_iterator;
+
+  RecordFile(std::string const& path, size_type buffered)
+      : path_(path), buffered_(buffered) {
+  }
+
+  iterator begin() const {
+    return iterator(helper::open_file(path_), path_, buffered_);
+  }
+
+  iterator end() const {
+    return iterator();
+  }
+
+ private:
+  std::string path_;
+  size_type buffered_;
+};
+
+template<typename T>
+RecordFile<T> record_file(std::string const& path, std::size_t buffered) {
+  return RecordFile<T>(path, buffered);
+}
+
+template<typename T>
+RecordFile<T> record_file(std::string const& path) {
+  return RecordFile<T>(path, 4096);
+}
+
+// lines
+// The lines of a text file, read `chunk_size` bytes at a time, each as a
+// std::string without its line terminator, which is either "\n" or "\r\n".
+// The string is reused from line to line, so memory stays bounded by the
+// chunk size plus the longest line. Like record_file, this is a single pass
+// source.
+class Lines {
+ public:
+  typedef std::string value_type;
+  typedef std::size_t size_type;
+
+  class iterator {
+   public:
+    typedef std::input_iterator_tag iterator_category;
+    typedef std::string value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef std::string const* pointer;
+    typedef std::string const& reference;
+
+    iterator() {
+    }
+
+    iterator(
+        std::shared_ptr<std::FILE> const& file,
+        std::string const& path,
+        size_type chunk_size)
+        : reader_(new Reader(file, path, chunk_size)) {
+      if (!reader_->next()) {
+        reader_.reset();
+      }
+    }
+
+    std::string const& operator*() const {
+      return reader_->current();
+    }
+
+    std::string const* operator->() const {
+      return &reader_->current();
+    }
+
+    iterator& operator++() {
+      if (!reader_->next()) {
+        reader_.reset();
+      }
+      return *this;
+    }
+
+    void operator++(int) {
+      ++*this;
+    }
+
+    bool operator==(iterator const& other) const {
+      return reader_ == other.reader_;
+    }
+
+    bool operator!=(iterator const& other) const {
+      return !(*this == other);
+    }
+
+   private:
+    class Reader {
+     public:
+      Reader(
+          std::shared_ptr<std::FILE> const& file,
+          std::string const& path,
+          size_type chunk_size)
+          : file_(file),
+            path_(path),
+            chunk_(chunk_size ? chunk_size : 1),
+            position_(0),
+            count_(0) {
+      }
+
+      std::string const& current() const {
+        return line_;
+      }
+
+      bool next() {
+        line_.clear();
+        bool read_any = false;
+        for (;;) {
+          if (position_ == count_) {
+            count_ = helper::read_file(
+                &chunk_[0],
+                1,
+                chunk_.size(),
+                file_.get(),
+                path_);
+            position_ = 0;
+            if (count_ == 0) {
+              return read_any;
+            }
+          }
+          read_any = true;
+          char const* start = &chunk_[0] + position_;
+          char const* newline = static_cast<char const*>(
+              std::memchr(start, '\n', count_ - position_));
+          if (newline) {
+            line_.append(start, newline);
+            position_ += newline - start + 1;
+            if (!line_.empty() && line_[line_.size() - 1] == '\r') {
+              line_.erase(line_.size() - 1);
+            }
+            return true;
+          }
+          line_.append(start, count_ - position_);
+          position_ = count_;
+        }
+      }
+
+     private:
+      std::shared_ptr<std::FILE> file_;
+      std::string path_;
+      std::vector<char> chunk_;
+      size_type position_;
+      size_type count_;
+      std::string line_;
+    };
+
+    std::shared_ptr<Reader> reader_;
+  };
+  typedef iterator const_iterator;
+
+  Lines(std::string const& path, size_type chunk_size)
+      : path_(path), chunk_size_(chunk_size) {
+  }
+
+  iterator begin() const {
+    return iterator(helper::open_file(path_), path_, chunk_size_);
+  }
+
+  iterator end() const {
+    return iterator();
+  }
+
+ private:
+  std::string path_;
+  size_type chunk_size_;
+};
+
+inline Lines lines(std::string const& path, std::size_t chunk_size) {
+  return Lines(path, chunk_size);
+}
+
+inline Lines lines(std::string const& path) {
+  return Lines(path, 1 << 16);
+}
+
+}  // namespace underscore
+
+#endif  // UNDERSCORE_STREAM_H_
@@ -0,0 +1,208 @@
+#ifndef UNDERSCORE_UTILITY_H_
+#define UNDERSCORE_UTILITY_H_
+
+// Utility: identity and unique_id. The other Underscore.js utilities aren't
+// implemented yet, and range lives with the arrays functions.
+
+#if __cplusplus >= 201103L
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#endif
+
+#include "helper.h"
+
+namespace underscore {
+
+// noConflict
+// times
+// mixin
+
+// identity
+// Returns its argument. It can be passed wherever a projection is expected,
+// e.g. to reach the allocator overload of a scan without projecting.
+struct Identity {
+  template<typename T>
+  T const& operator()(T const& value) const {
+    return value;
+  }
+};
+
+// An inline variable where there are any, so that the module can export it.
+#if __cplusplus >= 201703L
+inline constexpr Identity identity = Identity();
+#else
+Identity const identity = Identity();
+#endif
+
+#if __cplusplus >= 201103L
+// unique_id
+// Positive 64-bit IDs that are unique within the process. Each thread claims
+// a block of IDs from a shared atomic counter and then hands them out with a
+// thread-local increment, so threads only contend once per block. The IDs a
+// thread gets are increasing, but IDs from different threads interleave in no
+// particular order, and the unused part of a block is lost when its thread
+// exits.
+namespace helper {
+std::uint64_t const kUniqueIdBlock = 4096;
+
+struct UniqueIdBlock {
+  std::uint64_t next;
+  std::uint64_t end;
+};
+
+inline std::atomic<std::uint64_t>& unique_id_counter() {
+  static std::atomic<std::uint64_t> counter(1);
+  return counter;
+}
+
+inline UniqueIdBlock& unique_id_block() {
+  static thread_local UniqueIdBlock block = {0, 0};
+  return block;
+}
+
+// Writes the decimal digits of value to the end of buffer, which has room for
+// the 20 digits of the largest value, and returns the first digit.
+inline char* format_decimal(std::uint64_t value, char* end) {
+  do {
+    *--end = static_cast<char>('0' + value % 10);
+    value /= 10;
+  } while (value);
+  return end;
+}
+}  // namespace helper
+
+inline std::uint64_t unique_id() {
+  helper::UniqueIdBlock& block = helper::unique_id_block();
+  if (block.next == block.end) {
+    block.next = helper::unique_id_counter().fetch_add(
+        helper::kUniqueIdBlock,
+        std::memory_order_relaxed);
+    block.end = block.next + helper::kUniqueIdBlock;
+  }
+  return block.next++;
+}
+
+// Writes `prefix` followed by a new unique_id() to buffer as a
+// null-terminated string, like `_.uniqueId(prefix)`, and returns its length.
+// Nothing is allocated. A buffer of the prefix's length plus 21 characters is
+// always large enough; if the buffer is too small, it is left holding an
+// empty string (when size is not 0) and 0 is returned.
+inline std::size_t unique_id(
+    char const* prefix,
+    char* buffer,
+    std::size_t size) {
+  char digits[20];
+  char* const digits_end = digits + sizeof(digits);
+  char const* const first_digit =
+      helper::format_decimal(unique_id(), digits_end);
+
+  std::size_t length = 0;
+  for (; prefix[length] != '\0'; ++length) {
+    if (length == size) {
+      break;
+    }
+    buffer[length] = prefix[length];
+  }
+  std::size_t const digit_count =
+      static_cast<std::size_t>(digits_end - first_digit);
+  if (prefix[length] != '\0' || size - length <= digit_count) {
+    if (size) {
+      buffer[0] = '\0';
+    }
+    return 0;
+  }
+  for (char const* digit = first_digit; digit != digits_end; ++digit) {
+    buffer[length++] = *digit;
+  }
+  buffer[length] = '\0';
+  return length;
+}
+
+template<std::size_t Size>
+std::size_t unique_id(char const* prefix, char (&buffer)[Size]) {
+  return unique_id(prefix, buffer, Size);
+}
+
+// Snowflake
+// Generates 64-bit IDs that are unique across up to 1024 workers, e.g.
+// machines or processes, and that sort by creation time:
+//
+//   | 0 | 41 bits: ms since epoch | 10 bits: worker | 12 bits: sequence |
+//
+// next() is lock-free and can be called from any number of threads. The IDs
+// from one generator are strictly increasing, even if the clock moves
+// backward or more than 4096 IDs are requested in one millisecond: the
+// generator then keeps counting on from the last ID it returned, running
+// ahead of the clock until the clock catches up. Clock is a std::chrono clock,
+// which can be replaced to control time in tests.
+template<typename Clock = std::chrono::system_clock>
+class Snowflake {
+ public:
+  static unsigned const kWorkerBits = 10;
+  static unsigned const kSequenceBits = 12;
+  static unsigned const kWorkers = 1u << kWorkerBits;
+  // 2020-01-01T00:00:00Z, in milliseconds since the Unix epoch.
+  static std::uint64_t const kDefaultEpoch = 1577836800000ULL;
+
+  explicit Snowflake(unsigned worker, std::uint64_t epoch = kDefaultEpoch)
+      : worker_(worker), epoch_(epoch), last_(0) {
+    if (worker >= kWorkers) {
+      throw std::invalid_argument("Snowflake worker must be less than 1024");
+    }
+  }
+
+  std::uint64_t next() {
+    // The state is the last timestamp and sequence as a single counter, so
+    // running out of sequence numbers carries into the next millisecond.
+    std::uint64_t const now = milliseconds() << kSequenceBits;
+    std::uint64_t last = last_.load(std::memory_order_relaxed);
+    std::uint64_t tick;
+    do {
+      tick = now > last ? now : last + 1;
+    } while (!last_.compare_exchange_weak(
+        last,
+        tick,
+        std::memory_order_relaxed));
+    return ((tick >> kSequenceBits) << (kWorkerBits + kSequenceBits)) |
+        (static_cast<std::uint64_t>(worker_) << kSequenceBits) |
+        (tick & ((1u << kSequenceBits) - 1));
+  }
+
+  // The milliseconds since the epoch, worker and sequence an ID was made of.
+  static std::uint64_t timestamp(std::uint64_t id) {
+    return id >> (kWorkerBits + kSequenceBits);
+  }
+
+  static unsigned worker(std::uint64_t id) {
+    return static_cast<unsigned>(id >> kSequenceBits) & (kWorkers - 1);
+  }
+
+  static unsigned sequence(std::uint64_t id) {
+    return static_cast<unsigned>(id) & ((1u << kSequenceBits) - 1);
+  }
+
+ private:
+  std::uint64_t milliseconds() const {
+    long long const now =
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            Clock::now().time_since_epoch()).count();
+    return now > 0 && static_cast<std::uint64_t>(now) > epoch_ ?
+        static_cast<std::uint64_t>(now) - epoch_ :
+        0;
+  }
+
+  unsigned const worker_;
+  std::uint64_t const epoch_;
+  std::atomic<std::uint64_t> last_;
+};
+#endif
+
+// escape
+// template
+
+}  // namespace underscore
+
+#endif  // UNDERSCORE_UTILITY_H_
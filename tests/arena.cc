@@ -0,0 +1,31 @@
+// Tests for the arena, which needs C++17.
+
+#include <memory_resource>
+#include <new>
+#include <vector>
+
+#include "check.h"
+#include "underscore.h"
+#include "underscore/arena.h"
+
+namespace {
+
+bool is_even(int value) {
+  return value % 2 == 0;
+}
+
+UNDERSCORE_TEST(arena_keeps_results_off_the_heap) {
+  _::Arena<1024> arena(std::pmr::null_memory_resource());
+  std::vector<int> const values{1, 2, 3, 4};
+  std::pmr::vector<int> const evens =
+      _::filter<std::pmr::vector<int> >(values, is_even, arena.allocator());
+  CHECK(evens.size() == 2);
+  CHECK(evens.get_allocator().resource() == arena.resource());
+
+  std::vector<int> const large(1024, 2);
+  CHECK_THROWS(
+      _::filter<std::pmr::vector<int> >(large, is_even, arena.allocator()),
+      std::bad_alloc);
+}
+
+}  // namespace
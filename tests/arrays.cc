@@ -0,0 +1,242 @@
+// Tests for the Arrays functions added on top of the original ones.
+
+#include <algorithm>
+#include <list>
+#include <memory_resource>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "check.h"
+#include "underscore.h"
+
+namespace {
+
+bool is_even(int value) {
+  return value % 2 == 0;
+}
+
+int identity(int value) {
+  return value;
+}
+
+int last_digit(int value) {
+  return value % 10;
+}
+
+std::vector<int> one_to(int count) {
+  std::vector<int> values;
+  for (int i = 1; i <= count; ++i) {
+    values.push_back(i);
+  }
+  return values;
+}
+
+template<typename Slice>
+std::vector<int> elements(Slice const& slice) {
+  return std::vector<int>(slice.begin(), slice.end());
+}
+
+UNDERSCORE_TEST(chunk_splits_into_consecutive_slices) {
+  std::list<int> values(7, 0);
+  int next = 0;
+  for (std::list<int>::iterator i = values.begin(); i != values.end(); ++i) {
+    *i = next++;
+  }
+  auto const chunks = _::chunk(values, 3);
+  CHECK(chunks.size() == 3);
+  std::vector<std::vector<int> > seen;
+  for (auto i = chunks.begin(); i != chunks.end(); ++i) {
+    seen.push_back(elements(*i));
+  }
+  CHECK((seen == std::vector<std::vector<int> >{{0, 1, 2}, {3, 4, 5}, {6}}));
+
+  // The slices refer to the container instead of copying it.
+  *(*chunks.begin()).begin() = 42;
+  CHECK(values.front() == 42);
+
+  std::vector<int> empty;
+  CHECK(_::chunk(empty, 3).empty());
+  CHECK(_::chunk(values, 0).size() == 0);
+}
+
+UNDERSCORE_TEST(sliding_window_visits_every_run) {
+  std::vector<int> const values = one_to(4);
+  auto const windows = _::sliding_window(values, 2);
+  CHECK(windows.size() == 3);
+  std::vector<std::vector<int> > seen;
+  for (auto i = windows.begin(); i != windows.end(); ++i) {
+    seen.push_back(elements(*i));
+  }
+  CHECK((seen == std::vector<std::vector<int> >{{1, 2}, {2, 3}, {3, 4}}));
+  CHECK(_::sliding_window(values, 5).size() == 0);
+}
+
+UNDERSCORE_TEST(partition_is_stable) {
+  std::vector<int> const values = one_to(6);
+  std::pair<std::vector<int>, std::vector<int> > const parts =
+      _::partition<std::vector<int> >(values, is_even);
+  CHECK((parts.first == std::vector<int>{2, 4, 6}));
+  CHECK((parts.second == std::vector<int>{1, 3, 5}));
+
+  std::vector<int> evens(3);
+  std::vector<int> odds(3);
+  auto const ends = _::partition(values, is_even, evens.begin(), odds.begin());
+  CHECK(ends.first == evens.end() && ends.second == odds.end());
+  CHECK(evens == parts.first && odds == parts.second);
+}
+
+UNDERSCORE_TEST(partition_in_place_moves_matches_first) {
+  std::vector<int> values = one_to(6);
+  std::vector<int>::iterator const middle =
+      _::stable_partition_in_place(values, is_even);
+  CHECK((values == std::vector<int>{2, 4, 6, 1, 3, 5}));
+  CHECK(middle == values.begin() + 3);
+
+  std::vector<int> unstable = one_to(6);
+  std::vector<int>::iterator const split =
+      _::partition_in_place(unstable, is_even);
+  CHECK(split == unstable.begin() + 3);
+  CHECK(std::count_if(unstable.begin(), split, is_even) == 3);
+}
+
+UNDERSCORE_TEST(compact_and_without_in_place) {
+  std::vector<int> values{0, 1, 0, 2, 3, 0};
+  _::compact_in_place(values);
+  CHECK((values == std::vector<int>{1, 2, 3}));
+
+  _::without_in_place(values, 2);
+  CHECK((values == std::vector<int>{1, 3}));
+
+  std::multiset<int> set{1, 2, 2, 3};
+  _::without_in_place(set, 2);
+  CHECK((set == std::multiset<int>{1, 3}));
+}
+
+UNDERSCORE_TEST(uniq_in_place_keeps_the_first_of_each_key) {
+  std::vector<int> values{3, 1, 3, 2, 1};
+  _::uniq_in_place(values, false);
+  CHECK((values == std::vector<int>{3, 1, 2}));
+
+  std::vector<int> sorted{1, 1, 2, 2, 2, 3};
+  _::unique_in_place(sorted, true);
+  CHECK((sorted == std::vector<int>{1, 2, 3}));
+
+  std::vector<int> keyed{11, 21, 12, 31, 22};
+  _::uniq_in_place(keyed, last_digit);
+  CHECK((keyed == std::vector<int>{11, 12}));
+
+  std::vector<int> sorted_keys{11, 21, 12, 22, 13};
+  _::unique_in_place(sorted_keys, true, last_digit);
+  CHECK((sorted_keys == std::vector<int>{11, 12, 13}));
+
+  std::string text = "abracadabra";
+  _::uniq_in_place(text, false);
+  CHECK(text == "abrcd");
+
+  std::multiset<int> set{1, 1, 2, 3, 3};
+  _::uniq_in_place(set, true);
+  CHECK((set == std::multiset<int>{1, 2, 3}));
+}
+
+struct Pairs {
+  void operator()(int left, int right) const {
+    matches->push_back(std::make_pair(left, right));
+  }
+
+  std::vector<std::pair<int, int> >* matches;
+};
+
+UNDERSCORE_TEST(joins_match_equal_keys) {
+  std::vector<int> const left{1, 2, 3, 12};
+  std::vector<int> const right{2, 22, 4};
+
+  std::vector<std::pair<int, int> > matches;
+  Pairs const sink = {&matches};
+  _::join<int>(left, right, last_digit, last_digit, sink);
+  std::sort(matches.begin(), matches.end());
+  std::vector<std::pair<int, int> > const expected{
+      {2, 2}, {2, 22}, {12, 2}, {12, 22}};
+  CHECK(matches == expected);
+
+  matches.clear();
+  _::sort_merge_join<int>(left, right, last_digit, last_digit, sink);
+  std::sort(matches.begin(), matches.end());
+  CHECK(matches == expected);
+
+  std::vector<int> unmatched;
+  _::left_join<int>(
+      left,
+      right,
+      last_digit,
+      last_digit,
+      [&unmatched](int value, int const* match) {
+        if (!match) {
+          unmatched.push_back(value);
+        }
+      });
+  CHECK((unmatched == std::vector<int>{1, 3}));
+
+  CHECK((_::semi_join<std::vector<int>, int>(
+      left,
+      right,
+      identity,
+      identity) == std::vector<int>{2}));
+  CHECK((_::anti_join<std::vector<int>, int>(
+      left,
+      right,
+      last_digit,
+      last_digit) == std::vector<int>{1, 3}));
+}
+
+UNDERSCORE_TEST(allocator_overloads_use_the_allocator) {
+  std::pmr::monotonic_buffer_resource arena;
+  std::pmr::polymorphic_allocator<char> const allocator(&arena);
+  std::vector<int> values = one_to(6);
+
+  std::pmr::vector<int> const head =
+      _::first<std::pmr::vector<int> >(values, 2, allocator);
+  CHECK((head == std::pmr::vector<int>{1, 2}));
+  CHECK(head.get_allocator().resource() == &arena);
+  CHECK((_::rest<std::pmr::vector<int> >(values, 4, allocator) ==
+      std::pmr::vector<int>{5, 6}));
+  CHECK((_::initial<std::pmr::vector<int> >(values, 5, allocator) ==
+      std::pmr::vector<int>{1}));
+  CHECK((_::last<std::pmr::list<int> >(values, 1, allocator) ==
+      std::pmr::list<int>{6}));
+
+  std::pair<std::pmr::vector<int>, std::pmr::vector<int> > const parts =
+      _::partition<std::pmr::vector<int> >(values, is_even, allocator);
+  CHECK(parts.first.get_allocator().resource() == &arena);
+  CHECK(parts.second.get_allocator().resource() == &arena);
+
+  std::vector<std::vector<int> > const nested{{1, 2}, {3}};
+  CHECK((_::flatten<std::pmr::vector<int>, true>(nested, allocator) ==
+      std::pmr::vector<int>{1, 2, 3}));
+
+  std::vector<int> const repeated{11, 21, 12};
+  CHECK((_::uniq<std::pmr::vector<int>, int>(
+      repeated,
+      last_digit,
+      allocator) == std::pmr::vector<int>{11, 12}));
+
+  std::vector<int> const right{2, 4};
+  std::pmr::vector<int> const matched =
+      _::semi_join<std::pmr::vector<int>, int>(
+          values,
+          right,
+          identity,
+          identity,
+          allocator);
+  CHECK((matched == std::pmr::vector<int>{2, 4}));
+  CHECK(matched.get_allocator().resource() == &arena);
+  CHECK((_::anti_join<std::pmr::vector<int>, int>(
+      values,
+      right,
+      identity,
+      identity,
+      allocator).size() == 4));
+}
+
+}  // namespace
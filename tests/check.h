@@ -0,0 +1,67 @@
+#ifndef UNDERSCORE_TESTS_CHECK_H_
+#define UNDERSCORE_TESTS_CHECK_H_
+
+// A small self-contained test harness. Every test is a function registered
+// with UNDERSCORE_TEST, and CHECK records a failure without stopping the
+// test, so one run reports every broken expectation. main.cc runs all the
+// tests linked into an executable and fails if any check did. The harness
+// itself only needs C++98, so that the C++98 paths can be tested with it.
+
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+
+namespace tests {
+
+typedef void (*Test)();
+
+struct Registered {
+  char const* name;
+  Test test;
+};
+
+std::vector<Registered>& registry();
+
+// The number of failed checks so far.
+std::size_t& failures();
+
+inline void fail(char const* file, int line, char const* expression) {
+  ++failures();
+  std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+}
+
+struct Registration {
+  Registration(char const* name, Test test) {
+    Registered const registered = {name, test};
+    registry().push_back(registered);
+  }
+};
+
+}  // namespace tests
+
+// Defines and registers a test function.
+#define UNDERSCORE_TEST(name)                                               \
+  static void name();                                                       \
+  static ::tests::Registration const name##_registration(#name, &name);     \
+  static void name()
+
+#define CHECK(expression)                                                   \
+  ((expression) ?                                                           \
+      static_cast<void>(0) :                                                \
+      ::tests::fail(__FILE__, __LINE__, #expression))
+
+// Checks that the statement throws an exception of the given type.
+#define CHECK_THROWS(statement, Exception)                                  \
+  do {                                                                      \
+    bool underscore_thrown_ = false;                                        \
+    try {                                                                   \
+      statement;                                                            \
+    } catch (Exception const&) {                                            \
+      underscore_thrown_ = true;                                            \
+    }                                                                       \
+    if (!underscore_thrown_) {                                              \
+      ::tests::fail(__FILE__, __LINE__, #statement " throws " #Exception); \
+    }                                                                       \
+  } while (false)
+
+#endif  // UNDERSCORE_TESTS_CHECK_H_
@@ -0,0 +1,292 @@
+// Tests for the Collections functions added on top of the original ones.
+
+#include <atomic>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <memory_resource>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+#include "check.h"
+#include "underscore.h"
+
+namespace {
+
+int add(int memo, int value) {
+  return memo + value;
+}
+
+int twice(int value) {
+  return value * 2;
+}
+
+bool is_even(int value) {
+  return value % 2 == 0;
+}
+
+bool greater(int left, int right) {
+  return left > right;
+}
+
+std::vector<int> one_to(int count) {
+  std::vector<int> values;
+  for (int i = 1; i <= count; ++i) {
+    values.push_back(i);
+  }
+  return values;
+}
+
+UNDERSCORE_TEST(scan_folds_every_prefix) {
+  std::vector<int> const values = one_to(4);
+  std::vector<int> const sums = _::scan<std::vector<int> >(values, add, 0);
+  CHECK((sums == std::vector<int>{1, 3, 6, 10}));
+  CHECK((_::inclusive_scan<std::vector<int> >(values, add, 0, twice) ==
+      std::vector<int>{2, 6, 12, 20}));
+  CHECK(_::scan<std::vector<int> >(std::vector<int>(), add, 0).empty());
+
+  std::vector<int> output(4);
+  CHECK(_::scan_to(values, output.begin(), add, 10) == output.end());
+  CHECK((output == std::vector<int>{11, 13, 16, 20}));
+}
+
+UNDERSCORE_TEST(exclusive_scan_starts_with_the_memo) {
+  std::vector<int> const values = one_to(4);
+  CHECK((_::exclusive_scan<std::vector<int> >(values, add, 0) ==
+      std::vector<int>{0, 1, 3, 6}));
+  CHECK((_::exclusive_scan<std::list<int> >(values, add, 5, twice) ==
+      std::list<int>{5, 7, 11, 17}));
+
+  std::vector<int> output;
+  _::exclusive_scan_to(values, std::back_inserter(output), add, 0);
+  CHECK((output == std::vector<int>{0, 1, 3, 6}));
+}
+
+UNDERSCORE_TEST(scan_in_place_overwrites_the_input) {
+  std::vector<int> values = one_to(4);
+  _::scan_in_place(values, add);
+  CHECK((values == std::vector<int>{1, 3, 6, 10}));
+
+  std::list<int> list(4, 1);
+  _::exclusive_scan_in_place(list, add, 0);
+  CHECK((list == std::list<int>{0, 1, 2, 3}));
+}
+
+UNDERSCORE_TEST(parallel_scans_match_the_sequential_ones) {
+  std::vector<int> input(100000);
+  for (std::size_t i = 0; i < input.size(); ++i) {
+    input[i] = static_cast<int>(i % 7);
+  }
+
+  std::vector<int> sequential = input;
+  _::scan_in_place(sequential, add);
+  std::vector<int> parallel = input;
+  _::scan_in_place_parallel(parallel, add, 4);
+  CHECK(parallel == sequential);
+
+  sequential = input;
+  _::exclusive_scan_in_place(sequential, add, 3);
+  parallel = input;
+  _::exclusive_scan_in_place_parallel(parallel, add, 3, 4);
+  CHECK(parallel == sequential);
+}
+
+UNDERSCORE_TEST(filter_and_reject_in_place) {
+  std::vector<int> vector = one_to(6);
+  _::filter_in_place(vector, is_even);
+  CHECK((vector == std::vector<int>{2, 4, 6}));
+
+  std::set<int> set(vector.begin(), vector.end());
+  set.insert(7);
+  _::reject_in_place(set, is_even);
+  CHECK((set == std::set<int>{7}));
+
+  std::list<int> list(3, 2);
+  _::select_in_place(list, is_even);
+  CHECK(list.size() == 3);
+}
+
+struct Shape {
+  virtual ~Shape() {
+  }
+
+  virtual void draw() = 0;
+
+  std::vector<char>* log;
+};
+
+struct Circle : Shape {
+  void draw() {
+    log->push_back('c');
+  }
+};
+
+struct Square : Shape {
+  void draw() {
+    log->push_back('s');
+  }
+};
+
+UNDERSCORE_TEST(invoke_grouped_runs_each_type_together) {
+  std::vector<char> log;
+  std::vector<std::unique_ptr<Shape> > shapes;
+  char const kinds[] = "csscsc";
+  for (char const* kind = kinds; *kind; ++kind) {
+    if (*kind == 'c') {
+      shapes.emplace_back(new Circle);
+    } else {
+      shapes.emplace_back(new Square);
+    }
+    shapes.back()->log = &log;
+  }
+
+  _::invoke_grouped(shapes, &Shape::draw);
+  CHECK((log == std::vector<char>{'c', 'c', 'c', 's', 's', 's'}));
+
+  // Alternating types still run each type together.
+  std::vector<std::unique_ptr<Shape> > alternating;
+  for (int i = 0; i < 8; ++i) {
+    if (i % 2) {
+      alternating.emplace_back(new Square);
+    } else {
+      alternating.emplace_back(new Circle);
+    }
+    alternating.back()->log = &log;
+  }
+  log.clear();
+  _::invoke_grouped(alternating, &Shape::draw);
+  CHECK((log == std::vector<char>{'c', 'c', 'c', 'c', 's', 's', 's', 's'}));
+
+  // A reused buffer gives the same result.
+  _::InvokeGroupedBuffer<Shape> buffer;
+  for (int run = 0; run < 2; ++run) {
+    log.clear();
+    _::invoke_grouped(shapes, &Shape::draw, buffer);
+    CHECK((log == std::vector<char>{'c', 'c', 'c', 's', 's', 's'}));
+  }
+}
+
+struct Ticket {
+  void record() {
+    order->push_back(id);
+  }
+
+  int id;
+  int priority;
+  std::vector<int>* order;
+};
+
+struct Priority {
+  int operator()(Ticket const& ticket) const {
+    return ticket.priority;
+  }
+};
+
+UNDERSCORE_TEST(invoke_grouped_groups_by_tag_in_first_seen_order) {
+  std::vector<int> order;
+  int const priorities[] = {3, 1, 2, 3, 1, 2, 3};
+  std::vector<Ticket> tickets(7);
+  std::vector<Ticket*> pointers;
+  for (int i = 0; i < 7; ++i) {
+    Ticket const ticket = {i, priorities[i], &order};
+    tickets[i] = ticket;
+    pointers.push_back(&tickets[i]);
+  }
+  _::invoke_grouped<int>(pointers, &Ticket::record, Priority());
+  CHECK((order == std::vector<int>{0, 3, 6, 1, 4, 2, 5}));
+}
+
+struct Counter {
+  void increment() {
+    ++*count;
+  }
+
+  void fail() {
+    throw std::runtime_error("fail");
+  }
+
+  std::atomic<int>* count;
+};
+
+UNDERSCORE_TEST(invoke_grouped_parallel_invokes_every_element) {
+  std::atomic<int> count(0);
+  std::vector<Counter> counters(1000);
+  std::vector<Counter*> pointers;
+  for (std::size_t i = 0; i < counters.size(); ++i) {
+    counters[i].count = &count;
+    pointers.push_back(&counters[i]);
+  }
+  _::invoke_grouped_parallel(pointers, &Counter::increment, 4);
+  CHECK(count == 1000);
+
+  CHECK_THROWS(
+      _::invoke_grouped_parallel(pointers, &Counter::fail, 4),
+      std::runtime_error);
+}
+
+UNDERSCORE_TEST(find_parallel_returns_the_first_match) {
+  std::vector<int> values(100000, 1);
+  values[70000] = 2;
+  values[90000] = 2;
+  CHECK(_::find_parallel(values, is_even, 4) == values.begin() + 70000);
+  CHECK(_::detect_parallel(values, is_even) == values.begin() + 70000);
+
+  values[70000] = 1;
+  values[90000] = 1;
+  CHECK(_::find_parallel(values, is_even, 4) == values.end());
+}
+
+struct ThrowsOnTwo {
+  bool operator()(int value) const {
+    if (value == 2) {
+      throw std::invalid_argument("two");
+    }
+    return false;
+  }
+};
+
+UNDERSCORE_TEST(find_parallel_rethrows_the_predicates_exception) {
+  std::vector<int> values(100000, 1);
+  values[50000] = 2;
+  CHECK_THROWS(
+      _::find_parallel(values, ThrowsOnTwo(), 4),
+      std::invalid_argument);
+}
+
+UNDERSCORE_TEST(allocator_overloads_use_the_allocator) {
+  std::pmr::monotonic_buffer_resource arena;
+  std::pmr::polymorphic_allocator<char> const allocator(&arena);
+  std::vector<int> const values = one_to(4);
+
+  std::pmr::vector<int> const evens =
+      _::filter<std::pmr::vector<int> >(values, is_even, allocator);
+  CHECK(evens.get_allocator().resource() == &arena);
+  CHECK(evens.size() == 2);
+
+  std::pmr::vector<int> const sums = _::scan<std::pmr::vector<int> >(
+      values,
+      add,
+      0,
+      _::identity,
+      allocator);
+  CHECK(sums.get_allocator().resource() == &arena);
+  CHECK(sums.back() == 10);
+
+  std::pmr::vector<int> const offsets =
+      _::exclusive_scan<std::pmr::vector<int> >(
+          values,
+          add,
+          0,
+          twice,
+          allocator);
+  CHECK(offsets.get_allocator().resource() == &arena);
+  CHECK(offsets.back() == 12);
+
+  std::pmr::vector<int> const sorted =
+      _::sort_by<std::pmr::vector<int> >(values, greater, allocator);
+  CHECK(sorted.get_allocator().resource() == &arena);
+  CHECK((sorted == std::pmr::vector<int>{4, 3, 2, 1}));
+}
+
+}  // namespace
@@ -0,0 +1,80 @@
+// Tests for the coroutine layer, which needs C++20.
+
+#include <atomic>
+#include <vector>
+
+#include "check.h"
+#include "underscore.h"
+#include "underscore/coroutine.h"
+
+namespace {
+
+_::generator<int> count_from(int start) {
+  for (int i = start;; ++i) {
+    co_yield i;
+  }
+}
+
+_::async_generator<int> count_async(int count) {
+  for (int i = 0; i < count; ++i) {
+    co_yield i;
+  }
+}
+
+int square(int value) {
+  return value * value;
+}
+
+bool is_even(int value) {
+  return value % 2 == 0;
+}
+
+int add(int memo, int value) {
+  return memo + value;
+}
+
+UNDERSCORE_TEST(generators_are_lazy) {
+  // The source is infinite, so this only ends if take stops pulling.
+  std::vector<int> seen;
+  _::each(
+      _::take(_::filter(_::map(count_from(1), square), is_even), 3),
+      [&seen](int value) { seen.push_back(value); });
+  CHECK((seen == std::vector<int>{4, 16, 36}));
+
+  CHECK(_::reduce(_::take(count_from(1), 4), add, 0) == 10);
+  CHECK(_::chain(_::take(count_from(1), 4)).map(square).reduce(add, 0).value()
+      == 30);
+}
+
+UNDERSCORE_TEST(async_generators_run_through_a_buffer) {
+  _::ThreadPool pool(2);
+  int const sum = _::sync_wait(_::reduce(
+      _::buffer(_::map(count_async(1000), square), pool, 16),
+      add,
+      0));
+  int expected = 0;
+  for (int i = 0; i < 1000; ++i) {
+    expected += i * i;
+  }
+  CHECK(sum == expected);
+
+  CHECK(_::sync_wait(_::reduce(_::take(count_async(1000), 10), add, 0)) == 45);
+}
+
+UNDERSCORE_TEST(async_generators_chain_through_a_buffer) {
+  _::ThreadPool pool(2);
+  CHECK(_::sync_wait(_::chain(count_async(1000))
+      .map(square)
+      .buffer(pool, 16)
+      .filter(is_even)
+      .take(3)
+      .reduce(add, 0)) == 0 + 4 + 16);
+
+  std::vector<int> seen;
+  _::sync_wait(_::chain(count_async(4))
+      .buffer(pool, 1)
+      .each([&seen](int value) { seen.push_back(value); }));
+  CHECK((seen == std::vector<int>{0, 1, 2, 3}));
+}
+
+}  // namespace
@@ -0,0 +1,67 @@
+// Tests built as C++98, for the paths that are only taken when the C++11
+// dispatch isn't available.
+
+#include <list>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "check.h"
+#include "underscore.h"
+
+namespace {
+
+bool is_vowel(char character) {
+  return std::string("aeiou").find(character) != std::string::npos;
+}
+
+bool is_even(int value) {
+  return value % 2 == 0;
+}
+
+int add(int memo, int value) {
+  return memo + value;
+}
+
+UNDERSCORE_TEST(strings_are_compacted_as_sequences) {
+  std::string text = "abracadabra";
+  _::uniq_in_place(text, false);
+  CHECK(text == "abrcd");
+
+  _::reject_in_place(text, is_vowel);
+  CHECK(text == "brcd");
+}
+
+UNDERSCORE_TEST(associative_containers_erase_nodes) {
+  std::set<int> set;
+  std::list<int> list;
+  for (int i = 0; i < 6; ++i) {
+    set.insert(i);
+    list.push_back(i % 3);
+  }
+  _::filter_in_place(set, is_even);
+  CHECK(set.size() == 3 && *set.begin() == 0 && *set.rbegin() == 4);
+
+  _::uniq_in_place(list, false);
+  CHECK(list.size() == 3);
+}
+
+UNDERSCORE_TEST(scans_and_partitions) {
+  std::vector<int> values;
+  for (int i = 1; i <= 4; ++i) {
+    values.push_back(i);
+  }
+  std::vector<int> const sums = _::scan<std::vector<int> >(values, add, 0);
+  CHECK(sums.size() == 4 && sums[3] == 10);
+
+  std::pair<std::vector<int>, std::vector<int> > const parts =
+      _::partition<std::vector<int> >(values, is_even);
+  CHECK(parts.first.size() == 2 && parts.first[0] == 2);
+  CHECK(parts.second.size() == 2 && parts.second[0] == 1);
+
+  std::vector<int> const rest =
+      _::rest<std::vector<int> >(values, 2, std::allocator<char>());
+  CHECK(rest.size() == 2 && rest[0] == 3);
+}
+
+}  // namespace
@@ -0,0 +1,93 @@
+// Tests for the out-of-core sort and group. The budgets are small enough
+// that every input spills several runs and merges them in more than one
+// level.
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "check.h"
+#include "underscore/external.h"
+
+namespace {
+
+int tenth(int value) {
+  return value / 10;
+}
+
+std::vector<int> scrambled(int count) {
+  std::vector<int> values;
+  for (int i = 0; i < count; ++i) {
+    values.push_back(static_cast<int>((i * 2654435761ULL) % count));
+  }
+  return values;
+}
+
+UNDERSCORE_TEST(external_sort_by_matches_sort) {
+  std::vector<int> const values = scrambled(50000);
+  std::vector<int> expected = values;
+  std::sort(expected.begin(), expected.end(), std::greater<int>());
+
+  std::vector<int> sorted;
+  _::external_sort_by_to(
+      values,
+      std::back_inserter(sorted),
+      std::greater<int>(),
+      4096);
+  CHECK(sorted == expected);
+
+  sorted.clear();
+  _::external_sort_by(
+      std::vector<int>(),
+      std::less<int>(),
+      [&sorted](int value) { sorted.push_back(value); },
+      4096);
+  CHECK(sorted.empty());
+}
+
+UNDERSCORE_TEST(external_group_by_delivers_groups_in_key_order) {
+  std::vector<int> const values = scrambled(20000);
+  std::vector<std::pair<int, int> > grouped;
+  _::external_group_by<int>(
+      values,
+      tenth,
+      [&grouped](int key, int value) {
+        grouped.push_back(std::make_pair(key, value));
+      },
+      8192);
+  CHECK(grouped.size() == values.size());
+  bool ordered = true;
+  for (std::size_t i = 0; i < grouped.size(); ++i) {
+    ordered = ordered && grouped[i].first == tenth(grouped[i].second);
+    ordered = ordered && (i == 0 || grouped[i - 1].first <= grouped[i].first);
+  }
+  CHECK(ordered);
+}
+
+UNDERSCORE_TEST(external_group_by_keeps_input_order_within_groups) {
+  std::vector<int> const values = scrambled(20000);
+  std::vector<std::pair<int, int> > expected;
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    expected.push_back(std::make_pair(tenth(values[i]) % 7, values[i]));
+  }
+  std::stable_sort(
+      expected.begin(),
+      expected.end(),
+      [](std::pair<int, int> const& left, std::pair<int, int> const& right) {
+        return left.first < right.first;
+      });
+
+  std::vector<std::pair<int, int> > grouped;
+  _::external_group_by<int>(
+      values,
+      [](int value) { return tenth(value) % 7; },
+      [&grouped](int key, int value) {
+        grouped.push_back(std::make_pair(key, value));
+      },
+      1024);
+  CHECK(grouped == expected);
+}
+
+}  // namespace
@@ -0,0 +1,57 @@
+// Tests for the constexpr algorithms, which need C++17. The results are
+// checked with static_assert, so this file failing to compile is a failure
+// too.
+
+#include <array>
+#include <vector>
+
+#include "check.h"
+#include "underscore.h"
+#include "underscore/fixed.h"
+
+namespace {
+
+constexpr int square(int value) {
+  return value * value;
+}
+
+constexpr bool is_odd(int value) {
+  return value % 2 == 1;
+}
+
+constexpr int add(int memo, int value) {
+  return memo + value;
+}
+
+constexpr bool greater(int left, int right) {
+  return left > right;
+}
+
+constexpr auto squares = _::fixed::map<std::array<int, 8> >(
+    _::fixed::range<std::array<int, 8> >(8),
+    square);
+static_assert(squares[3] == 9, "");
+static_assert(_::fixed::reduce(squares, add, 0) == 140, "");
+
+constexpr auto odd_squares =
+    _::fixed::filter<_::fixed::StaticVector<int, 8> >(squares, is_odd);
+static_assert(odd_squares.size() == 4, "");
+static_assert(odd_squares[1] == 9, "");
+
+constexpr auto descending = _::fixed::sort_by(squares, greater);
+static_assert(descending[0] == 49, "");
+static_assert(_::fixed::index_of(squares, 25) == 5, "");
+
+constexpr std::array<int, 6> repeated{3, 1, 3, 2, 1, 2};
+constexpr auto distinct =
+    _::fixed::uniq<_::fixed::StaticVector<int, 6> >(repeated);
+static_assert(distinct.size() == 3, "");
+
+UNDERSCORE_TEST(fixed_results_match_the_runtime_ones) {
+  std::vector<int> const runtime = _::map<std::vector<int> >(
+      _::range<std::vector<int> >(8),
+      square);
+  CHECK(std::vector<int>(squares.begin(), squares.end()) == runtime);
+}
+
+}  // namespace
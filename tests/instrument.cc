@@ -0,0 +1,106 @@
+// Tests for the instrumentation hooks, in an executable of their own since
+// UNDERSCORE_INSTRUMENT changes every function.
+
+#define UNDERSCORE_INSTRUMENT
+
+#include <forward_list>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "check.h"
+#include "underscore.h"
+
+namespace {
+
+bool is_odd(int value) {
+  return value % 2 == 1;
+}
+
+// Keeps every record.
+class Recorder : public _::instrument::Sink {
+ public:
+  void record(_::instrument::Record const& record) {
+    records.push_back(record);
+  }
+
+  std::vector<_::instrument::Record> records;
+};
+
+UNDERSCORE_TEST(calls_report_their_element_counts) {
+  Recorder recorder;
+  _::instrument::set_sink(&recorder);
+  std::vector<int> const values{1, 2, 3, 4};
+  _::filter<std::vector<int> >(values, is_odd);
+  std::forward_list<int> const list{1, 2, 3};
+  _::filter<std::vector<int> >(list, is_odd);
+  _::intersection<std::vector<int> >(values, values);
+  _::instrument::set_sink(nullptr);
+
+  CHECK(recorder.records.size() == 3);
+  CHECK(std::string(recorder.records[0].name) == "filter");
+  CHECK(recorder.records[0].elements == 4);
+  CHECK(recorder.records[0].depth == 0);
+  CHECK(recorder.records[0].allocations > 0);
+  // A forward_list has no size(), so its count isn't known.
+  CHECK(recorder.records[1].elements == _::instrument::kUnknownElements);
+  CHECK(recorder.records[2].elements == 8);
+}
+
+UNDERSCORE_TEST(scratch_and_results_count_every_allocation) {
+  Recorder recorder;
+  _::instrument::set_sink(&recorder);
+  std::vector<int> const values{1, 2, 3, 4, 5};
+  _::uniq<std::vector<int> >(values, true);
+  _::union_of<std::set<int> >(std::vector<int>{1, 2, 3}, values);
+  _::instrument::set_sink(nullptr);
+
+  CHECK(recorder.records.size() == 2);
+  // The memo and the result grow alike, reallocating as they go.
+  CHECK(recorder.records[0].allocations % 2 == 0);
+  CHECK(recorder.records[0].allocations > 2);
+  CHECK(recorder.records[0].copies == 10);
+  // Two sorted copies and the merged scratch vector, one allocation each,
+  // then a node per element of the set.
+  CHECK(recorder.records[1].allocations == 3 + 5);
+  CHECK(recorder.records[1].copies == 3 + 5 + 5 + 5);
+}
+
+UNDERSCORE_TEST(counter_registry_totals_per_function) {
+  _::instrument::CounterRegistry registry;
+  _::instrument::set_sink(&registry);
+  std::vector<int> const values{1, 2, 3};
+  _::filter<std::vector<int> >(values, is_odd);
+  _::filter<std::vector<int> >(values, is_odd);
+  _::filter<std::vector<int> >(std::forward_list<int>{1}, is_odd);
+  _::instrument::set_sink(nullptr);
+
+  std::map<std::string, _::instrument::CounterRegistry::Counters> const
+      counters = registry.counters();
+  _::instrument::CounterRegistry::Counters const& filter =
+      counters.find("filter")->second;
+  CHECK(filter.calls == 3);
+  CHECK(filter.uncounted_calls == 1);
+  CHECK(filter.elements == 6);
+}
+
+UNDERSCORE_TEST(chrome_trace_writer_writes_complete_events) {
+  std::ostringstream output;
+  {
+    _::instrument::ChromeTraceWriter trace(output);
+    _::instrument::set_sink(&trace);
+    _::filter<std::vector<int> >(std::vector<int>{1, 2}, is_odd);
+    _::filter<std::vector<int> >(std::forward_list<int>{1}, is_odd);
+    _::instrument::set_sink(nullptr);
+  }
+  std::string const json = output.str();
+  CHECK(json[0] == '[');
+  CHECK(json.find("\n]\n") != std::string::npos);
+  CHECK(json.find("\"name\":\"filter\"") != std::string::npos);
+  CHECK(json.find("\"elements\":2") != std::string::npos);
+  CHECK(json.find("\"elements\":\"unknown\"") != std::string::npos);
+}
+
+}  // namespace
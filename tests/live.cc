@@ -0,0 +1,102 @@
+// Tests for the live views, checked against the results recomputed from the
+// container after every change.
+
+#include <map>
+#include <set>
+#include <unordered_set>
+#include <vector>
+
+#include "check.h"
+#include "underscore/live.h"
+
+namespace {
+
+long long plus(long long sum, int value) {
+  return sum + value;
+}
+
+long long minus(long long sum, int value) {
+  return sum - value;
+}
+
+int bucket(int value) {
+  return value % 3;
+}
+
+int zero(int) {
+  return 0;
+}
+
+bool is_even(int value) {
+  return value % 2 == 0;
+}
+
+UNDERSCORE_TEST(views_follow_every_change) {
+  _::Live<std::multiset<int> > live = _::live(std::multiset<int>{5, 1, 4});
+  auto const& sum = live.reduce(plus, minus, 0LL);
+  auto const& max = live.max();
+  auto const& min = live.min();
+  auto const& counts = live.count_by<int>(bucket);
+  auto const& groups = live.group_by<int>(bucket);
+  auto const& evens = live.filter<std::multiset<int> >(is_even);
+  CHECK(sum.value() == 10 && max.value() == 5 && min.value() == 1);
+
+  live.insert(9);
+  CHECK(!live.erase(7));
+  CHECK(live.erase(1));
+  CHECK(live.update(4, 0));
+  CHECK(!live.update(4, 0));
+
+  // The container is now {0, 5, 9}.
+  CHECK(sum.value() == 14 && max.value() == 9 && min.value() == 0);
+  CHECK((counts.value() == std::map<int, std::size_t>{{0, 2}, {2, 1}}));
+  CHECK(counts.count(1) == 0);
+  CHECK(groups.value().count(0) == 2 && groups.value().count(2) == 1);
+  CHECK((evens.value() == std::multiset<int>{0}));
+}
+
+UNDERSCORE_TEST(group_by_erases_the_matching_element) {
+  _::Live<std::vector<int> > live = _::live(std::vector<int>());
+  auto const& groups = live.group_by<int>(zero);
+  for (int i = 0; i < 1000; ++i) {
+    live.insert(i);
+  }
+  for (int i = 0; i < 1000; i += 2) {
+    live.erase(i);
+  }
+  CHECK(groups.value().size() == 500);
+  for (auto i = groups.value().begin(); i != groups.value().end(); ++i) {
+    CHECK(i->second % 2 == 1);
+  }
+}
+
+// Elements without < are erased from an index by searching their key.
+struct Unordered {
+  int value;
+
+  bool operator==(Unordered const& other) const {
+    return value == other.value;
+  }
+};
+
+int unordered_bucket(Unordered const& element) {
+  return element.value % 2;
+}
+
+UNDERSCORE_TEST(group_by_erases_elements_without_less_than) {
+  std::vector<Unordered> elements;
+  for (int i = 0; i < 6; ++i) {
+    Unordered const element = {i};
+    elements.push_back(element);
+  }
+  _::Live<std::vector<Unordered> > live = _::live(elements);
+  auto const& groups = live.group_by<int>(unordered_bucket);
+  Unordered const three = {3};
+  CHECK(live.erase(three));
+  CHECK(groups.value().count(1) == 2);
+  for (auto i = groups.value().begin(); i != groups.value().end(); ++i) {
+    CHECK(i->second.value != 3);
+  }
+}
+
+}  // namespace
@@ -0,0 +1,58 @@
+// Runs every registered test, or only those whose names contain the first
+// argument, and exits with 1 if any check failed.
+
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <vector>
+
+#include "check.h"
+
+namespace tests {
+
+std::vector<Registered>& registry() {
+  static std::vector<Registered> tests;
+  return tests;
+}
+
+std::size_t& failures() {
+  static std::size_t count = 0;
+  return count;
+}
+
+}  // namespace tests
+
+int main(int argc, char** argv) {
+  char const* filter = argc > 1 ? argv[1] : "";
+  std::vector<tests::Registered> const& registry = tests::registry();
+  std::size_t run = 0;
+  for (std::size_t i = 0; i < registry.size(); ++i) {
+    if (!std::strstr(registry[i].name, filter)) {
+      continue;
+    }
+    ++run;
+    std::size_t const before = tests::failures();
+    try {
+      registry[i].test();
+    } catch (std::exception const& exception) {
+      ++tests::failures();
+      std::fprintf(
+          stderr,
+          "%s: unexpected exception: %s\n",
+          registry[i].name,
+          exception.what());
+    } catch (...) {
+      ++tests::failures();
+      std::fprintf(stderr, "%s: unexpected exception\n", registry[i].name);
+    }
+    std::printf(
+        "%s %s\n",
+        tests::failures() == before ? "ok  " : "FAIL",
+        registry[i].name);
+  }
+  std::printf(
+      "%lu tests, %lu failed checks\n",
+      static_cast<unsigned long>(run),
+      static_cast<unsigned long>(tests::failures()));
+  return tests::failures() ? 1 : 0;
+}
@@ -0,0 +1,123 @@
+// Tests for the approximate sketches. The inputs are fixed, so the estimates
+// are deterministic; the bounds are the documented error rates with room to
+// spare.
+
+#include <stdexcept>
+#include <vector>
+
+#include "check.h"
+#include "underscore/sketch.h"
+
+namespace {
+
+int tenth(int value) {
+  return value / 10;
+}
+
+std::vector<int> range(int begin, int end) {
+  std::vector<int> values;
+  for (int i = begin; i < end; ++i) {
+    values.push_back(i);
+  }
+  return values;
+}
+
+UNDERSCORE_TEST(hyper_log_log_estimates_distinct_counts) {
+  std::vector<int> values = range(0, 100000);
+  values.insert(values.end(), values.begin(), values.begin() + 50000);
+  std::size_t const estimate = _::approx_count_distinct(values);
+  CHECK(estimate > 97000 && estimate < 103000);
+  CHECK(_::approx_count_distinct<int>(values, tenth) > 9700);
+  CHECK(_::approx_count_distinct<int>(values, tenth) < 10300);
+  CHECK(_::approx_count_distinct(std::vector<int>()) == 0);
+}
+
+UNDERSCORE_TEST(hyper_log_logs_of_parts_merge_into_the_whole) {
+  _::HyperLogLog<int> left = _::hyper_log_log(range(0, 60000), 14);
+  left.merge(_::hyper_log_log(range(40000, 100000), 14));
+  CHECK(left.count() > 97000 && left.count() < 103000);
+
+  CHECK_THROWS(
+      left.merge(_::HyperLogLog<int>(12)),
+      std::invalid_argument);
+}
+
+UNDERSCORE_TEST(bloom_filter_never_misses) {
+  std::vector<int> const values = range(0, 10000);
+  _::BloomFilter<int> const filter = _::bloom_filter(values, 0.01);
+  std::size_t false_positives = 0;
+  for (int i = 0; i < 20000; ++i) {
+    bool const found = filter.contains(i);
+    if (i < 10000) {
+      CHECK(found);
+    } else {
+      false_positives += found;
+    }
+  }
+  CHECK(false_positives < 400);
+}
+
+UNDERSCORE_TEST(bloom_filters_sized_alike_merge) {
+  _::BloomFilter<int> left = _::bloom_filter(range(0, 1000), 3000, 0.01);
+  left.merge(_::bloom_filter(range(1000, 3000), 3000, 0.01));
+  for (int i = 0; i < 3000; ++i) {
+    CHECK(left.contains(i));
+  }
+
+  // Sized from containers of different sizes, they can't be merged.
+  CHECK_THROWS(
+      _::bloom_filter(range(0, 1000), 0.01).merge(
+          _::bloom_filter(range(0, 2000), 0.01)),
+      std::invalid_argument);
+  CHECK_THROWS(
+      _::BloomFilter<int>(1000, 0.01).merge(_::BloomFilter<int>(1000, 0.1)),
+      std::invalid_argument);
+}
+
+UNDERSCORE_TEST(count_min_never_underestimates) {
+  std::vector<int> values;
+  for (int i = 0; i < 100; ++i) {
+    values.insert(values.end(), i + 1, i);
+  }
+  _::CountMin<int> sketch = _::count_min(values, 0.001, 0.01);
+  for (int i = 0; i < 100; ++i) {
+    unsigned long long const estimate = sketch.estimate(i);
+    CHECK(estimate >= static_cast<unsigned long long>(i + 1));
+    CHECK(estimate <= static_cast<unsigned long long>(i + 1) + 6);
+  }
+
+  sketch.merge(_::count_min(values, 0.001, 0.01));
+  CHECK(sketch.estimate(99) >= 200);
+  CHECK_THROWS(
+      sketch.merge(_::CountMin<int>(0.01, 0.01)),
+      std::invalid_argument);
+  CHECK_THROWS(
+      sketch.merge(_::CountMin<int>(0.001, 0.0001)),
+      std::invalid_argument);
+}
+
+UNDERSCORE_TEST(quantile_sketch_ranks_within_its_error) {
+  _::QuantileSketch<int> sketch = _::quantile_sketch(range(0, 50000));
+  sketch.merge(_::quantile_sketch(range(50000, 100000)));
+  CHECK(sketch.count() == 100000);
+  int const median = sketch.quantile(0.5);
+  CHECK(median > 47000 && median < 53000);
+  CHECK(sketch.quantile(0) < 2000);
+  CHECK(sketch.quantile(1) > 98000);
+  CHECK(_::QuantileSketch<int>().quantile(0.5) == 0);
+}
+
+UNDERSCORE_TEST(quantile_sketches_with_the_same_k_merge) {
+  // Merging a sketch into itself counts every value twice.
+  _::QuantileSketch<int> sketch = _::quantile_sketch(range(0, 100000));
+  sketch.merge(sketch);
+  CHECK(sketch.count() == 200000);
+  int const median = sketch.quantile(0.5);
+  CHECK(median > 47000 && median < 53000);
+
+  CHECK_THROWS(
+      sketch.merge(_::QuantileSketch<int>(100)),
+      std::invalid_argument);
+}
+
+}  // namespace
@@ -0,0 +1,76 @@
+// Tests for the file sources. Each test writes its input to a file in the
+// working directory, which ctest sets to the build directory.
+
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "check.h"
+#include "underscore.h"
+#include "underscore/stream.h"
+
+namespace {
+
+void write_file(std::string const& path, std::string const& contents) {
+  std::FILE* file = std::fopen(path.c_str(), "wb");
+  std::fwrite(contents.data(), 1, contents.size(), file);
+  std::fclose(file);
+}
+
+bool is_long(std::string const& line) {
+  return line.size() > 3;
+}
+
+UNDERSCORE_TEST(lines_strip_both_terminators) {
+  std::string const path = "underscore_tests_lines.txt";
+  write_file(path, "one\r\ntwo\nthree\r\n\nfour");
+  std::vector<std::string> const expected{"one", "two", "three", "", "four"};
+
+  // A small chunk size makes lines and terminators straddle chunks.
+  _::Lines const lines = _::lines(path, 3);
+  CHECK(std::vector<std::string>(lines.begin(), lines.end()) == expected);
+  CHECK((_::filter<std::vector<std::string> >(lines, is_long) ==
+      std::vector<std::string>{"three", "four"}));
+
+#ifdef UNDERSCORE_HAS_MMAP
+  _::MappedLines const mapped = _::mapped_lines(path);
+  std::vector<std::string> seen;
+  for (auto i = mapped.begin(); i != mapped.end(); ++i) {
+    seen.push_back(std::string((*i).begin(), (*i).end()));
+  }
+  CHECK(seen == expected);
+#endif
+  std::remove(path.c_str());
+}
+
+UNDERSCORE_TEST(record_files_read_whole_records) {
+  std::string const path = "underscore_tests_records.bin";
+  std::vector<int> const values{1, 2, 3, 4, 5};
+  // A trailing partial record is ignored.
+  write_file(
+      path,
+      std::string(
+          reinterpret_cast<char const*>(values.data()),
+          values.size() * sizeof(int)) + "xy");
+
+  _::RecordFile<int> const records = _::record_file<int>(path, 2);
+  CHECK(std::vector<int>(records.begin(), records.end()) == values);
+#ifdef UNDERSCORE_HAS_MMAP
+  _::MappedRecords<int> const mapped = _::mapped_records<int>(path);
+  CHECK(mapped.size() == values.size());
+  CHECK(std::vector<int>(mapped.begin(), mapped.end()) == values);
+#endif
+  std::remove(path.c_str());
+}
+
+UNDERSCORE_TEST(missing_files_throw) {
+  CHECK_THROWS(
+      _::lines("underscore_tests_missing.txt").begin(),
+      std::runtime_error);
+  CHECK_THROWS(
+      _::record_file<int>("underscore_tests_missing.bin").begin(),
+      std::runtime_error);
+}
+
+}  // namespace
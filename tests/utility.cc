@@ -0,0 +1,78 @@
+// Tests for unique_id and Snowflake.
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "check.h"
+#include "underscore.h"
+
+namespace {
+
+UNDERSCORE_TEST(unique_ids_are_unique_across_threads) {
+  std::vector<std::vector<std::uint64_t> > ids(4);
+  std::vector<std::thread> threads;
+  for (std::size_t t = 0; t < ids.size(); ++t) {
+    threads.emplace_back([&ids, t]() {
+      for (int i = 0; i < 10000; ++i) {
+        ids[t].push_back(_::unique_id());
+      }
+    });
+  }
+  for (std::size_t t = 0; t < threads.size(); ++t) {
+    threads[t].join();
+  }
+  std::set<std::uint64_t> all;
+  for (std::size_t t = 0; t < ids.size(); ++t) {
+    all.insert(ids[t].begin(), ids[t].end());
+  }
+  CHECK(all.size() == 40000);
+}
+
+UNDERSCORE_TEST(unique_id_formats_with_a_prefix) {
+  char buffer[32];
+  std::size_t const length = _::unique_id("user_", buffer);
+  CHECK(length == std::strlen(buffer));
+  CHECK(std::strncmp(buffer, "user_", 5) == 0);
+  CHECK(length > 5);
+}
+
+// A clock that stands still, so every ID falls in the same millisecond.
+struct FrozenClock {
+  typedef std::chrono::milliseconds duration;
+  typedef duration::rep rep;
+  typedef duration::period period;
+  typedef std::chrono::time_point<FrozenClock> time_point;
+  static bool const is_steady = false;
+
+  static time_point now() {
+    return time_point(duration(1577836800000LL + 5));
+  }
+};
+
+UNDERSCORE_TEST(snowflake_ids_increase_and_decompose) {
+  _::Snowflake<FrozenClock> generator(7);
+  std::uint64_t previous = generator.next();
+  CHECK(_::Snowflake<FrozenClock>::timestamp(previous) == 5);
+  CHECK(_::Snowflake<FrozenClock>::worker(previous) == 7);
+  CHECK(_::Snowflake<FrozenClock>::sequence(previous) == 0);
+
+  // Running out of sequence numbers carries into the next millisecond.
+  bool increasing = true;
+  for (int i = 0; i < 5000; ++i) {
+    std::uint64_t const id = generator.next();
+    increasing = increasing && id > previous;
+    previous = id;
+  }
+  CHECK(increasing);
+  CHECK(_::Snowflake<FrozenClock>::timestamp(previous) == 6);
+  CHECK(_::Snowflake<FrozenClock>::worker(previous) == 7);
+
+  CHECK_THROWS(_::Snowflake<>(1024), std::invalid_argument);
+}
+
+}  // namespace